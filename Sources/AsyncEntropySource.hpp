@@ -0,0 +1,101 @@
+/*  Асинхронный источник энтропии. Фоновый поток заранее получает
+    Depth значений от Inner и хранит их в заблокированной в памяти
+    (SecureBuffer) очереди. Запрос забирает готовое значение без
+    ожидания ввода-вывода; если очередь пуста, значение синхронно
+    запрашивается у Inner, как без предвыборки.
+    Фоновый поток один на процесс для каждого сочетания параметров
+    и запускается при создании первого источника.
+*/
+#ifndef ASYNC_ENTROPY_SOURCE_HPP
+#define ASYNC_ENTROPY_SOURCE_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "EntropySource.hpp"
+
+template <
+    size_t SeedLen,
+    IsEntropySource<SeedLen> Inner = GetrandomSource<SeedLen>,
+    size_t Depth = 4
+>
+class AsyncEntropySource : public EntropySource<SeedLen> {
+private:
+    class Prefetcher {
+    private:
+        const Inner source_;
+        std::mutex mutex_;
+        std::condition_variable refill_;
+        std::condition_variable filled_;
+        SecureBuffer<SeedLen> slots_[Depth];
+        size_t ready_ = 0;
+        bool stop_ = false;
+        bool failed_ = false;
+        std::thread thread_;
+
+        void run() {
+            std::unique_lock lock(mutex_);
+            while (true) {
+                refill_.wait(lock, [this] { return stop_ || ready_ < Depth; });
+                if (stop_) return;
+                lock.unlock();
+                SecureBuffer<SeedLen> entropy;
+                try { entropy = source_(); }
+                catch (const std::exception &e) {
+                    // Запросы продолжат обслуживаться синхронно и получат ошибку сами.
+                    LOG(ERROR) << "Фоновое получение энтропии остановлено: " << e.what();
+                    lock.lock();
+                    failed_ = true;
+                    filled_.notify_all();
+                    return;
+                }
+                lock.lock();
+                slots_[ready_++] = std::move(entropy);
+                if (ready_ == Depth) filled_.notify_all();
+            }
+        }
+    public:
+        inline Prefetcher() : thread_(&Prefetcher::run, this) {}
+        inline ~Prefetcher() {
+            { std::lock_guard lock(mutex_); stop_ = true; }
+            refill_.notify_one();
+            thread_.join();
+        }
+        inline bool tryTake(SecureBuffer<SeedLen> &entropy) {
+            {
+                std::lock_guard lock(mutex_);
+                if (!ready_) return false;
+                entropy = std::move(slots_[--ready_]);
+                slots_[ready_].zero();
+            }
+            refill_.notify_one();
+            return true;
+        }
+#ifdef UNIT_TESTS
+        inline bool waitFull() {
+            std::unique_lock lock(mutex_);
+            filled_.wait(lock, [this] { return failed_ || ready_ == Depth; });
+            return !failed_;
+        }
+#endif
+        inline static Prefetcher &instance() {
+            static Prefetcher prefetcher;
+            return prefetcher;
+        }
+    };
+public:
+    inline AsyncEntropySource() { Prefetcher::instance(); }
+    SecureBuffer<SeedLen> operator()() const override {
+        SecureBuffer<SeedLen> entropy;
+        if (Prefetcher::instance().tryTake(entropy)) return entropy;
+        LOG(INFO) << "Предвыбранная энтропия не готова, синхронный запрос";
+        return Inner()();
+    }
+#ifdef UNIT_TESTS
+    // Ожидание заполнения очереди; false, если фоновый поток остановился.
+    static inline bool waitUntilFull() { return Prefetcher::instance().waitFull(); }
+#endif
+};
+
+#endif
@@ -0,0 +1,57 @@
+/*  128-битный блок для промежуточных вычислений внутри шифров.
+    В отличие от SecureBuffer<16>, тривиально копируется и не владеет
+    памятью, поэтому компилятор может держать состояние в регистрах
+    между раундами. Данные попадают в SecureBuffer только на границе
+    API: load()/store() на входе и выходе, wipe() после использования.
+*/
+#ifndef BLOCK128_HPP
+#define BLOCK128_HPP
+
+#include <cstdint>
+#include <type_traits>
+#include "SecureBuffer.hpp"
+
+struct alignas(16) Block128 {
+    uint8_t bytes[16];
+
+    static inline Block128 load(const uint8_t *src) noexcept {
+        Block128 block;
+        __builtin_memcpy(block.bytes, src, 16);
+        return block;
+    }
+    static inline Block128 load(const SecureBuffer<16> &src) noexcept { return load(src.raw()); }
+    inline void store(uint8_t *dst) const noexcept { __builtin_memcpy(dst, bytes, 16); }
+    inline void store(SecureBuffer<16> &dst) const noexcept { store(dst.raw()); }
+    inline void wipe() noexcept { secureWipe(bytes, 16); }
+
+    inline uint8_t &operator[](const size_t i) noexcept { return bytes[i]; }
+    inline const uint8_t &operator[](const size_t i) const noexcept { return bytes[i]; }
+
+    // Сложение по модулю 2, как SecureBuffer::operator+=.
+    inline Block128 &operator^=(const Block128 &op) noexcept {
+        uint64_t a[2], b[2];
+        __builtin_memcpy(a, bytes, 16);
+        __builtin_memcpy(b, op.bytes, 16);
+        a[0] ^= b[0]; a[1] ^= b[1];
+        __builtin_memcpy(bytes, a, 16);
+        return *this;
+    }
+    // Сложение с 16 байтами в памяти без промежуточной копии на стеке:
+    // раундовые ключи не покидают расписание.
+    inline Block128 &xorFrom(const uint8_t *src) noexcept {
+        for (size_t i = 0; i < 16; ++i) bytes[i] ^= src[i];
+        return *this;
+    }
+};
+
+static_assert(std::is_trivially_copyable_v<Block128>);
+static_assert(sizeof(Block128) == 16 && alignof(Block128) == 16);
+
+// Шифр, который шифрует Block128 без записи в SecureBuffer и без затирания:
+// затирает вызывающий, один раз на границе своего API.
+template <typename T>
+concept HasBlock128 = requires(const T &cipher, Block128 &block) {
+    { cipher.encryptBlock(block) } noexcept;
+};
+
+#endif
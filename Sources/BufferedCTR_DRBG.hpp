@@ -0,0 +1,100 @@
+/*  Буферизованный ПДСЧ. Выход вырабатывается блоками по PoolSize байт
+    одним запросом к DRBGType и выдаётся по частям, поэтому update()
+    и ключевое расписание выполняются один раз на пул, а не на каждую
+    соль. Пул не превышает MaxBytesPerRequest, так что ограничения
+    SP 800-90A на один запрос соблюдаются. Выданные байты стираются
+    из пула.
+    Выход пула вырабатывается заранее: дополнительный вход запроса
+    учитывается при следующем пополнении пула, а не в уже выработанных
+    байтах. Если до пополнения приходит второй вход (или вход длиннее
+    SeedLen), пул пополняется сразу с ожидающим входом, а непрочитанный
+    остаток отбрасывается, так что ни один вход не теряется.
+    Запросы длиннее пула передаются DRBGType напрямую.
+*/
+#ifndef BUFFERED_CTR_DRBG_HPP
+#define BUFFERED_CTR_DRBG_HPP
+
+#include "CTR_DRBG.hpp"
+
+template <typename DRBGType, size_t PoolSize>
+class BufferedCTR_DRBG {
+    static_assert(PoolSize > 0 && PoolSize <= DRBGType::MaxBytesPerRequest,
+        "Пул должен вырабатываться одним запросом к ПДСЧ.");
+public:
+    static constexpr size_t SeedLen = DRBGType::SeedLen;
+    static constexpr size_t MaxBytesPerRequest = DRBGType::MaxBytesPerRequest;
+private:
+    DRBGType drbg_;
+    SecureBuffer<PoolSize> pool_;
+    size_t used_;
+    SecureBuffer<SeedLen> pending_input_;
+    size_t pending_input_len_;
+
+    inline void refill() {
+        drbg_(pool_.raw(), PoolSize,
+            pending_input_len_ ? pending_input_.raw() : nullptr, pending_input_len_);
+        pending_input_len_ = 0;
+        used_ = 0;
+    }
+    inline void discard() noexcept {
+        pool_.zero();
+        used_ = PoolSize;
+    }
+public:
+    inline BufferedCTR_DRBG(
+        const uint8_t *personalization_string = nullptr,
+        const size_t personalization_string_len = 0
+    ) : drbg_(personalization_string, personalization_string_len), used_(PoolSize), pending_input_len_(0) {}
+    inline void reseed(
+        const uint8_t *additional_input = nullptr,
+        const size_t additional_input_len = 0
+    ) {
+        discard();
+        drbg_.reseed(additional_input, additional_input_len);
+    }
+    void operator()(
+        uint8_t *buffer, size_t size,
+        const uint8_t *additional_input = nullptr,
+        const size_t additional_input_len = 0
+    );
+    inline uint64_t uint64(
+        const uint8_t *additional_input = nullptr,
+        const size_t additional_input_len = 0
+    ) {
+        uint64_t result;
+        (*this)(reinterpret_cast<uint8_t *>(&result), 8, additional_input, additional_input_len);
+        return result;
+    }
+};
+
+template <typename DRBGType, size_t PoolSize>
+void BufferedCTR_DRBG<DRBGType, PoolSize>::operator()(
+    uint8_t *buffer, size_t size,
+    const uint8_t *additional_input,
+    const size_t additional_input_len
+) {
+    if (size > PoolSize) {
+        drbg_(buffer, size, additional_input, additional_input_len);
+        return;
+    }
+    if (additional_input && additional_input_len) {
+        if (pending_input_len_) refill();
+        if (additional_input_len <= SeedLen) {
+            memcpy(pending_input_.raw(), additional_input, additional_input_len);
+            pending_input_len_ = additional_input_len;
+        }
+        else {
+            drbg_(pool_.raw(), PoolSize, additional_input, additional_input_len);
+            used_ = 0;
+        }
+    }
+    while (size) {
+        if (used_ == PoolSize) refill();
+        const size_t n = std::min(size, PoolSize - used_);
+        memcpy(buffer, pool_.raw() + used_, n);
+        memset(pool_.raw() + used_, 0, n);
+        buffer += n; size -= n; used_ += n;
+    }
+}
+
+#endif
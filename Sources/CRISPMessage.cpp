@@ -23,7 +23,7 @@ CRISPMessage::CRISPMessage(const std::vector<uint8_t> &message) {
     for (diff_type i = offset; i < offset + 6; ++i)
         seq_num_ = (seq_num_ << 8) | message[static_cast<size_t>(i)];
     const size_t ICV_length = getICVLength(cryptographic_suite_);
-    payload_ = std::vector(message.begin() + offset + 6,
+    payload_ = SecureVector(message.begin() + offset + 6,
         message.end() - static_cast<diff_type>(ICV_length));
     ICV_ = std::vector(message.end() - static_cast<diff_type>(ICV_length),
         message.end());
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "CryptographicSuites.hpp"
+#include "SecureVector.hpp"
 
 class CRISPMessage {
 public:
@@ -16,18 +17,18 @@ public:
         const bool external_key_id_flag,
         const uint16_t verison,
         const CryptographicSuites::ID cryptographic_suite,
-        const KeyID key_id,
+        KeyID key_id,
         const uint64_t seq_num,
-        const std::vector<uint8_t> payload,
-        const std::vector<uint8_t> ICV
+        SecureVector payload,
+        std::vector<uint8_t> ICV
     ) noexcept :
         external_key_id_flag_(external_key_id_flag),
         version_(verison),
         cryptographic_suite_(cryptographic_suite),
-        key_id_(key_id),
+        key_id_(std::move(key_id)),
         seq_num_(seq_num),
-        payload_(payload),
-        ICV_(ICV) {}
+        payload_(std::move(payload)),
+        ICV_(std::move(ICV)) {}
     CRISPMessage(const std::vector<uint8_t> &message);
     std::vector<uint8_t> serialize() const noexcept;
     inline bool externalKeyIDFlag() const noexcept
@@ -40,7 +41,7 @@ public:
         { return key_id_; }
     inline uint64_t seqNum() const noexcept
         { return seq_num_; }
-    inline const std::vector<uint8_t> &payload() const noexcept
+    inline const SecureVector &payload() const noexcept
         { return payload_; }
     inline const std::vector<uint8_t> &ICV() const noexcept
         { return ICV_; }
@@ -63,7 +64,7 @@ private:
     CryptographicSuites::ID cryptographic_suite_;
     KeyID key_id_;
     uint64_t seq_num_;
-    std::vector<uint8_t> payload_;
+    SecureVector payload_;
     std::vector<uint8_t> ICV_;
 };
 
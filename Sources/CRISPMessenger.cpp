@@ -1,3 +1,4 @@
+#include <array>
 #include <set>
 #include <future>
 #include "CRISPMessenger.hpp"
@@ -65,7 +66,7 @@ CRISPMessenger::CRISPMessenger(
         }
         throw;
     }
-    static const std::vector<uint8_t> error{'E', 'R', 'R', 'O', 'R'};
+    static constexpr uint8_t error[] = {'E', 'R', 'R', 'O', 'R'};
     static constexpr uint8_t rng_additional_info[] = {
         'C', 'R', 'I', 'S', 'P', 'M', 'e', 's',
         's', 'e', 'n', 'g', 'e', 'r', ' ', 'c',
@@ -76,13 +77,13 @@ CRISPMessenger::CRISPMessenger(
     try {
         getAndCheckKey(key_file.c_str(), master_key_);
     } catch(...) {
-        sendMessage(client_, {incSeqNum(client_seq_num_), error});
+        sendMessage(client_, {incSeqNum(client_seq_num_), SecureVector(error)});
         std::rethrow_exception(std::current_exception());
     }
     LOG(INFO) << "Начат обмен пробными сообщениями";
-    std::vector<uint8_t> local_ready(16);
+    std::array<uint8_t, 16> local_ready;
     rng_(local_ready.data(), local_ready.size(), rng_additional_info, sizeof(rng_additional_info));
-    sendMessage(client_, {incSeqNum(client_seq_num_), local_ready});
+    sendMessage(client_, {incSeqNum(client_seq_num_), SecureVector(local_ready)});
     MessageParts remote_ready = getMessage(server_);
     sendMessage(server_, {incSeqNum(remote_ready.seq_num), remote_ready.part});
     MessageParts local_ready_response = getMessage(client_);
@@ -136,7 +137,7 @@ CRISPMessenger::CRISPMessenger(
         }
         throw;
     }
-    static const std::vector<uint8_t> error{'E', 'R', 'R', 'O', 'R'};
+    static constexpr uint8_t error[] = {'E', 'R', 'R', 'O', 'R'};
     static constexpr uint8_t rng_additional_info[] = {
         'C', 'R', 'I', 'S', 'P', 'M', 'e', 's',
         's', 'e', 'n', 'g', 'e', 'r', ' ', 'c',
@@ -144,9 +145,9 @@ CRISPMessenger::CRISPMessenger(
         'o', 'r', 't', 'e', 's', 't', ' ', 'm',
         'e', 's', 's', 'a', 'g', 'e', '.'
     };
-    std::vector<uint8_t> local_ready(16);
+    std::array<uint8_t, 16> local_ready;
     rng_(local_ready.data(), local_ready.size(), rng_additional_info, sizeof(rng_additional_info));
-    sendMessage(client_, {incSeqNum(client_seq_num_), local_ready});
+    sendMessage(client_, {incSeqNum(client_seq_num_), SecureVector(local_ready)});
     MessageParts remote_ready = getMessage(server_);
     sendMessage(server_, {incSeqNum(remote_ready.seq_num), remote_ready.part});
     MessageParts local_ready_response = getMessage(client_);
@@ -158,17 +159,16 @@ CRISPMessenger::CRISPMessenger(
 }
 #endif
 
-std::vector<uint8_t> CRISPMessenger::encryptKuznechikCTR(const uint64_t seq_num, const std::vector<uint8_t> &data, const SecureBuffer<32> &key) noexcept {
-    const Kuznechik cipher(key);
-    std::vector<uint8_t> payload = data;
+void CRISPMessenger::encryptKuznechikCTR(const uint64_t seq_num, std::span<const uint8_t> src, std::span<uint8_t> dst, const SecureBuffer<32> &key) {
+    auto cipher = ContextPool<Kuznechik>::local().acquire();
+    cipher->initKeySchedule(key);
     uint8_t IV[16];
     uint64_t temp = seq_num;
     for (uint8_t i = 0; i < 16; ++i) {
         IV[15 - i] = static_cast<uint8_t>(temp);
         temp >>= 8;
     }
-    CTREncrypt<16, 32>(cipher, payload.data(), payload.size(), IV);
-    return payload;
+    CTREncrypt<16, 32>(*cipher, src, dst, IV);
 }
 
 CRISPMessenger::MessageParts CRISPMessenger::getMessage(const TCP &tcp) const {
@@ -416,27 +416,28 @@ void CRISPMessenger::chooseMessageFormer() {
 }
 
 void CRISPMessenger::send(std::string msg, bool is_file) {
-    static const std::vector<uint8_t> accept{'A', 'C', 'C', 'E', 'P', 'T'};
+    static constexpr uint8_t accept[] = {'A', 'C', 'C', 'E', 'P', 'T'};
     LOG(INFO) << "Подготовка к отправке сообщения";
-    std::vector<uint8_t> data;
+    SecureVector data;
+    std::ifstream file;
+    size_t total_size;
     if (is_file) {
-        LOG(INFO) << "Начато считывание файла для отправки";
-        const size_t filesize = std::filesystem::file_size(msg);
-        if (filesize > size_t(2) * 1024 * 1024 * 1024)
+        // Файл считывается частями по max_payload_size_ байт непосредственно
+        // перед отправкой, чтобы не держать его в памяти целиком.
+        total_size = std::filesystem::file_size(msg);
+        if (total_size > size_t(2) * 1024 * 1024 * 1024)
             throw crispex::send_error("Файл больше 2Гб.");
-        data.resize(filesize);
-        std::ifstream file(msg, std::ios::binary);
+        file.open(msg, std::ios::binary);
         if (!file) throw crispex::privilege_error("Не удалось открыть файл" + msg + ".");
-        file.read(reinterpret_cast<char *>(data.data()), static_cast<std::streamsize>(filesize));
-        if (!file) throw crispex::privilege_error("Ошибка при чтении файла " + msg + ".");
-        LOG(INFO) << "Файл для отправки успешно считан";
+        LOG(INFO) << "Файл для отправки открыт";
     }
     else {
-        data = std::vector<uint8_t>(msg.begin(), msg.end());
+        data = SecureVector(msg.begin(), msg.end());
+        total_size = data.size();
         LOG(INFO) << "Декодировано текстовое сообщение для отправки";
     }
-    const size_t num_of_full_payloads = data.size() / max_payload_size_;
-    const size_t remainder_payload_size = data.size() % max_payload_size_;
+    const size_t num_of_full_payloads = total_size / max_payload_size_;
+    const size_t remainder_payload_size = total_size % max_payload_size_;
     const size_t num_messages = num_of_full_payloads + (remainder_payload_size == 0 ? 0 : 1);
     uint8_t num_messages_bytes[8];
     size_t temp = num_messages;
@@ -462,7 +463,7 @@ void CRISPMessenger::send(std::string msg, bool is_file) {
             " Количество CRISP сообщений: " << num_messages <<
             " Тип: текст";
     }
-    sendMessage(client_, {incSeqNum(client_seq_num_), size_type});
+    sendMessage(client_, {incSeqNum(client_seq_num_), SecureVector(size_type)});
     LOG(INFO) << "Информационное сообщение отправлено. Ожидается ответ";
     MessageParts info_response = getMessage(client_);
     incSeqNum(client_seq_num_); incSeqNum(client_seq_num_);
@@ -470,12 +471,19 @@ void CRISPMessenger::send(std::string msg, bool is_file) {
         throw crispex::send_error("Второй участник отказался от получения сообщения.");
     LOG(INFO) << "Сервер удалённой стороны согласился на отправку."
         " Будет отправлено " << num_messages << " CRISP сообщений";
-    for (size_t i = 0; i < num_of_full_payloads; ++i)
-        sendMessage(client_, {incSeqNum(client_seq_num_),
-            std::vector<uint8_t>(data.begin() + static_cast<std::vector<uint8_t>::difference_type>(i * max_payload_size_),
-            data.begin() + static_cast<std::vector<uint8_t>::difference_type>((i+1) * max_payload_size_))});
-    if (remainder_payload_size > 0)
-        sendMessage(client_, {incSeqNum(client_seq_num_),
-            std::vector<uint8_t>(data.end() - static_cast<std::vector<uint8_t>::difference_type>(remainder_payload_size), data.end())});
+    for (size_t i = 0; i < num_messages; ++i) {
+        const size_t offset = i * max_payload_size_;
+        const size_t part_size = std::min(max_payload_size_, total_size - offset);
+        SecureVector part;
+        if (is_file) {
+            part.resize(part_size);
+            file.read(reinterpret_cast<char *>(part.data()), static_cast<std::streamsize>(part_size));
+            if (!file) throw crispex::privilege_error("Ошибка при чтении файла " + msg + ".");
+        }
+        else
+            part.assign(data.begin() + static_cast<std::ptrdiff_t>(offset),
+                data.begin() + static_cast<std::ptrdiff_t>(offset + part_size));
+        sendMessage(client_, {incSeqNum(client_seq_num_), std::move(part)});
+    }
     LOG(INFO) << "Отправка окончена";
 }
\ No newline at end of file
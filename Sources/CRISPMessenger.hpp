@@ -2,13 +2,16 @@
 #define CRISP_MESSENGER_HPP
 
 #include <filesystem>
+#include <span>
 #include "TCP.hpp"
-#include "CTR_DRBG.hpp"
+#include "ShardedCTR_DRBG.hpp"
+#include "AsyncEntropySource.hpp"
 #include "CRISPMessage.hpp"
 #include "KDF_R_13235651022.hpp"
 #include "NMAC256.hpp"
 #include "HMAC.hpp"
 #include "SimpleMAC.hpp"
+#include "ContextPool.hpp"
 #include "Utils.hpp"
 
 inline static std::string bytesToString(const uint8_t *bytes, const size_t size) noexcept {
@@ -41,7 +44,7 @@ private:
 
     struct MessageParts {
         uint64_t seq_num;
-        std::vector<uint8_t> part;
+        SecureVector part;
         inline bool operator<(const MessageParts &other) const noexcept { return seq_num < other.seq_num; }
         inline uint8_t &operator[](size_t i) noexcept { return part[i]; }
         inline const uint8_t &operator[](size_t i) const noexcept { return part[i]; }
@@ -53,7 +56,7 @@ private:
     TCPClient client_;
     const CryptographicSuites::ID server_cryptographic_suite_;
     MessageFormer formMessage;
-    CTR_DRBG<Kuznechik, true> rng_;
+    ShardedCTR_DRBG<Kuznechik, true, AsyncEntropySource<48>, 4096> rng_;
     uint64_t client_seq_num_;
     MasterKeySecureBuffer<32> master_key_;
     uint8_t local_user_info_[16];
@@ -74,20 +77,26 @@ private:
     inline static bool checkMAC_KuznechikCMAC_256_128_R13235651022(const CRISPMessage &message, const SecureBuffer<32> &mac_key) noexcept {
         uint8_t mac[16];
         memcpy(mac, message.ICV().data() + 32, 16);
-        OMAC<Kuznechik> macer(mac_key);
-        macer.update(message.payload());
+        auto macer = ContextPool<OMAC<Kuznechik>>::local().acquire();
+        macer->initKeySchedule(mac_key);
+        macer->update(message.payload().data(), message.payload().size());
         uint8_t calculated_mac[16];
-        macer.digest(calculated_mac);
+        macer->digest(calculated_mac);
         return !memcmp(mac, calculated_mac, 16);
     }
 
-    static std::vector<uint8_t> encryptKuznechikCTR(const uint64_t seq_num, const std::vector<uint8_t> &data, const SecureBuffer<32> &key) noexcept;
-    inline static std::vector<uint8_t> decryptKuznechikCTR(const uint64_t seq_num, const std::vector<uint8_t> &data, const SecureBuffer<32> &key) noexcept
+    static void encryptKuznechikCTR(const uint64_t seq_num, std::span<const uint8_t> src, std::span<uint8_t> dst, const SecureBuffer<32> &key);
+    inline static SecureVector encryptKuznechikCTR(const uint64_t seq_num, const SecureVector &data, const SecureBuffer<32> &key) noexcept {
+        SecureVector result = SecureVector::uninitialized(data.size());
+        encryptKuznechikCTR(seq_num, data, result, key);
+        return result;
+    }
+    inline static SecureVector decryptKuznechikCTR(const uint64_t seq_num, const SecureVector &data, const SecureBuffer<32> &key) noexcept
         { return encryptKuznechikCTR(seq_num, data, key); }
     
     template <IsMAC InnerMAC, IsMAC OuterMAC>
     requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
-    inline std::vector<uint8_t> handleNULL_KuznechikCMAC_256_128_R13235651022(const CRISPMessage &message, const uint8_t (&user_info)[16]) const {
+    inline SecureVector handleNULL_KuznechikCMAC_256_128_R13235651022(const CRISPMessage &message, const uint8_t (&user_info)[16]) const {
         SecureBuffer<32> salt;
         std::copy(message.ICV().begin(), message.ICV().begin() + 32, salt.begin());
         SecureBuffer<32> mac_key;
@@ -100,7 +109,7 @@ private:
 
     template <IsMAC InnerMAC, IsMAC OuterMAC>
     requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
-    inline std::vector<uint8_t> handleKuznechikCTR_KuznechikCMAC_256_128_R13235651022(const CRISPMessage &message, const uint8_t (&user_info)[16]) const {
+    inline SecureVector handleKuznechikCTR_KuznechikCMAC_256_128_R13235651022(const CRISPMessage &message, const uint8_t (&user_info)[16]) const {
         SecureBuffer<32> salt;
         std::copy(message.ICV().begin(), message.ICV().begin() + 32, salt.begin());
         KeyPair<32, 32> keys;
@@ -160,26 +169,28 @@ public:
 template <IsMAC InnerMAC, IsMAC OuterMAC>
 requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
 void CRISPMessenger::getKuznechikCMAC_256_128_R13235651022MacKey(uint64_t seq_num, SecureBuffer<32> &mac_key, const SecureBuffer<32> &salt, const uint8_t (&user_info)[16]) const noexcept {
-    KDF_R_13235651022<InnerMAC, OuterMAC, 32> kdf(master_key_, salt);
+    auto kdf = ContextPool<KDF_R_13235651022<InnerMAC, OuterMAC, 32>>::local().acquire();
+    kdf->init(master_key_, salt);
     uint8_t IV[OuterMAC::DigestSize];
     for (uint8_t i = 0; i < OuterMAC::DigestSize; ++i) {
         IV[OuterMAC::DigestSize - 1 - i] = static_cast<uint8_t>(seq_num);
         seq_num >>= 8;
     }
-    kdf.fetch(mac_key.raw(), 32, IV, kdf_mac_application_info, user_info, kdf_additional_info);
+    kdf->fetch(mac_key.raw(), 32, IV, kdf_mac_application_info, user_info, kdf_additional_info);
 }
 
 template <IsMAC InnerMAC, IsMAC OuterMAC>
 requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
 void CRISPMessenger::getKuznechikCTR_KuznechikCMAC_256_128_R13235651022Keys(uint64_t seq_num, KeyPair<32, 32> &keys, const SecureBuffer<32> &salt, const uint8_t (&user_info)[16]) const noexcept {
-    KDF_R_13235651022<InnerMAC, OuterMAC, 32> kdf(master_key_, salt);
+    auto kdf = ContextPool<KDF_R_13235651022<InnerMAC, OuterMAC, 32>>::local().acquire();
+    kdf->init(master_key_, salt);
     uint8_t IV[OuterMAC::DigestSize];
     for (uint8_t i = 0; i < OuterMAC::DigestSize; ++i) {
         IV[OuterMAC::DigestSize - 1 - i] = static_cast<uint8_t>(seq_num);
         seq_num >>= 8;
     }
-    kdf.fetch(keys.mac_key.raw(), 32, IV, kdf_mac_application_info, user_info, kdf_additional_info);
-    kdf.fetch(keys.encryption_key.raw(), 32, IV, kdf_key_application_info, user_info, kdf_additional_info);
+    kdf->fetch(keys.mac_key.raw(), 32, IV, kdf_mac_application_info, user_info, kdf_additional_info);
+    kdf->fetch(keys.encryption_key.raw(), 32, IV, kdf_key_application_info, user_info, kdf_additional_info);
 }
 
 inline static std::string sanitizeFilename(const std::string& raw) {
@@ -208,14 +219,15 @@ CRISPMessage CRISPMessenger::formNULL_KuznechikCMAC_256_128_R13235651022CRISPMes
     rng_(salt.raw(), 32, rng_additional_info, sizeof(rng_additional_info));
     SecureBuffer<32> mac_key;
     getKuznechikCMAC_256_128_R13235651022MacKey<InnerMAC, OuterMAC>(message.seq_num, mac_key, salt, local_user_info_);
-    OMAC<Kuznechik> macer(mac_key);
-    macer.update(message.part);
+    auto macer = ContextPool<OMAC<Kuznechik>>::local().acquire();
+    macer->initKeySchedule(mac_key);
+    macer->update(message.part.data(), message.part.size());
 
     std::vector<uint8_t> ICV(48);
     std::copy(salt.begin(), salt.end(), ICV.begin());
-    macer.digest(ICV.data() + 32);
+    macer->digest(ICV.data() + 32);
 
-    return CRISPMessage(false, 0, server_cryptographic_suite_, {0, {}, 0}, message.seq_num, message.part, ICV);
+    return CRISPMessage(false, 0, server_cryptographic_suite_, {0, {}, 0}, message.seq_num, message.part, std::move(ICV));
 }
 
 template <IsMAC InnerMAC, IsMAC OuterMAC>
@@ -237,15 +249,16 @@ CRISPMessage CRISPMessenger::formKuznechikCTR_KuznechikCMAC_256_128_R13235651022
     KeyPair<32, 32> keys;
     getKuznechikCTR_KuznechikCMAC_256_128_R13235651022Keys<InnerMAC, OuterMAC>(message.seq_num, keys, salt, local_user_info_);
 
-    std::vector<uint8_t> payload = encryptKuznechikCTR(message.seq_num, message.part, keys.encryption_key);
-    OMAC<Kuznechik> macer(keys.mac_key);
-    macer.update(payload);
+    SecureVector payload = encryptKuznechikCTR(message.seq_num, message.part, keys.encryption_key);
+    auto macer = ContextPool<OMAC<Kuznechik>>::local().acquire();
+    macer->initKeySchedule(keys.mac_key);
+    macer->update(payload.data(), payload.size());
 
     std::vector<uint8_t> ICV(48);
     std::copy(salt.begin(), salt.end(), ICV.begin());
-    macer.digest(ICV.data() + 32);
+    macer->digest(ICV.data() + 32);
 
-    return CRISPMessage(false, 0, server_cryptographic_suite_, {0, {}, 0}, message.seq_num, payload, ICV);
+    return CRISPMessage(false, 0, server_cryptographic_suite_, {0, {}, 0}, message.seq_num, std::move(payload), std::move(ICV));
 }
 
 #endif
\ No newline at end of file
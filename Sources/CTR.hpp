@@ -1,57 +1,171 @@
 #ifndef CTR_HPP
 #define CTR_HPP
 
-#ifndef DONT_USE_TBB
-#include <tbb/parallel_for.h>
-#include <tbb/blocked_range.h>
-#endif
+#include <span>
 
-#define SECUREBUFFER_BIG_ENDIAN_COUNTER
 #include "Cipher.hpp"
+#include "ParallelPolicy.hpp"
+#include "CRISPExceptions.hpp"
+
+// Число блоков гаммы, вырабатываемых за одно обращение к шифру.
+inline constexpr size_t CTRBatchBlocks = 32;
+
+// Запись count счётчиков IV + first, IV + first + 1, ... подряд в out.
+// Для 128-битного блока счётчик складывается как пара 64-битных
+// big-endian слов с переносом, без побайтового add().
+template <size_t BlockSize>
+static inline void CTRCounters(
+    uint8_t *out, const uint8_t *IV,
+    const uint64_t first, const size_t count
+) noexcept {
+    if constexpr (BlockSize == 16) {
+        uint64_t high, low;
+        __builtin_memcpy(&high, IV, 8);
+        __builtin_memcpy(&low, IV + 8, 8);
+        high = be64toh(high);
+        low = be64toh(low);
+        if (__builtin_add_overflow(low, first, &low)) ++high;
+        for (size_t i = 0; i < count; ++i) {
+            const uint64_t lane[2] = {htobe64(high), htobe64(low)};
+            __builtin_memcpy(out + i * 16, lane, 16);
+            if (++low == 0) ++high;
+        }
+    }
+    else {
+        SecureBuffer<BlockSize> counter;
+        memcpy(counter.raw(), IV, BlockSize);
+        counter.template add<std::endian::big>(first);
+        for (size_t i = 0; i < count; ++i) {
+            memcpy(out + i * BlockSize, counter.raw(), BlockSize);
+            counter.template add<std::endian::big>(1);
+        }
+    }
+}
+
+// Гаммирование блоков с номерами [begin, end) на счётчиках IV + first + i,
+// как в ГОСТ Р 34.13-2018. in и out могут совпадать.
+template <size_t BlockSize, size_t KeySize>
+static inline void CTRBlockRange(
+    const Cipher<BlockSize, KeySize> &cipher,
+    const uint8_t *IV, const uint64_t first,
+    const uint8_t *in, uint8_t *out,
+    const size_t begin, const size_t end
+) {
+    SecureBuffer<BlockSize * CTRBatchBlocks> keystream;
+    for (size_t i = begin; i < end; i += CTRBatchBlocks) {
+        const size_t count = std::min(CTRBatchBlocks, end - i);
+        CTRCounters<BlockSize>(keystream.raw(), IV, first + i, count);
+        cipher.encryptBlocks(keystream.raw(), count);
+        xorBytes(out + i * BlockSize, in + i * BlockSize, keystream.raw(), count * BlockSize);
+    }
+}
+
+template <size_t BlockSize, size_t KeySize>
+static inline void CTRBlocks(
+    const Cipher<BlockSize, KeySize> &cipher,
+    const uint8_t *IV, const uint64_t first,
+    const uint8_t *in, uint8_t *out, const size_t num_of_blocks
+) {
+    ParallelPolicy::forBlocks(num_of_blocks, [&](const size_t begin, const size_t end) {
+        CTRBlockRange(cipher, IV, first, in, out, begin, end);
+    });
+}
 
+// Шифрование src в dst, буферы могут совпадать. dst должен вмещать src.
 template <size_t BlockSize, size_t KeySize>
 void CTREncrypt(
     const Cipher<BlockSize, KeySize> &cipher,
-    uint8_t *data, size_t size,
+    const std::span<const uint8_t> src, const std::span<uint8_t> dst,
     const uint8_t (&IV)[BlockSize]
 ) {
+    if (dst.size() < src.size())
+        throw crispex::invalid_argument("Выходной буфер CTR меньше входного.");
     LOG(INFO) << "Начато шифрование/дешифрование в режиме CTR";
-    size_t num_of_blocks = size / BlockSize;
-    size_t remainder = size % BlockSize;
-    SecureBuffer<BlockSize> state(IV);
-#ifndef DONT_USE_TBB
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_of_blocks, 128),
-    [&](const tbb::blocked_range<size_t>& r) {
-        SecureBuffer<BlockSize> block;
-        for (size_t i = r.begin(); i != r.end(); ++i) {
-            block = state;
-            block.add(i);
-            cipher.encrypt(block);
-            std::transform(data + i * BlockSize, data + (i+1) * BlockSize, block.begin(), data + i * BlockSize, std::bit_xor<uint8_t>());
-        }
-    });
-    state.add(num_of_blocks);
-    data += num_of_blocks * BlockSize;
-#else
-    SecureBuffer<BlockSize> block;
-    for (size_t i = 0; i < num_of_blocks; ++i) {
-        state.add(1);
-        block = state;
-        cipher.encrypt(block);
-        std::transform(data, data + BlockSize, block.begin(), data, std::bit_xor<uint8_t>());
-        data += BlockSize;
-    }
-#endif
+    const size_t num_of_blocks = src.size() / BlockSize;
+    const size_t remainder = src.size() % BlockSize;
+    CTRBlocks(cipher, IV, 0, src.data(), dst.data(), num_of_blocks);
+    // Неполный последний блок шифруется на счётчике IV + num_of_blocks
+    // (ГОСТ Р 34.13-2018, п. 5.2). Ранние версии брали IV + num_of_blocks + 1,
+    // поэтому сообщения некратной блоку длины с ними несовместимы.
     if (remainder > 0) {
-        state.add(1);
-        SecureBuffer<BlockSize> block(state);
-        cipher.encrypt(block);
-        std::transform(data, data + remainder, block.begin(), data, std::bit_xor<uint8_t>());
+        alignas(16) uint8_t keystream[BlockSize];
+        CTRCounters<BlockSize>(keystream, IV, num_of_blocks, 1);
+        cipher.encryptBlocks(keystream, 1);
+        const size_t offset = num_of_blocks * BlockSize;
+        xorBytes(dst.data() + offset, src.data() + offset, keystream, remainder);
+        secureWipe(keystream, BlockSize);
     }
     LOG(INFO) << "Закончено шифрование/дешифрование в режиме CTR";
 }
 
 template <size_t BlockSize, size_t KeySize>
-const auto CTRDecrypt = CTREncrypt<BlockSize, KeySize>;
+inline void CTREncrypt(
+    const Cipher<BlockSize, KeySize> &cipher,
+    uint8_t *data, const size_t size,
+    const uint8_t (&IV)[BlockSize]
+) { CTREncrypt(cipher, std::span<const uint8_t>(data, size), std::span<uint8_t>(data, size), IV); }
+
+template <size_t BlockSize, size_t KeySize>
+const auto CTRDecrypt = static_cast<void (*)(
+    const Cipher<BlockSize, KeySize> &, uint8_t *, size_t, const uint8_t (&)[BlockSize]
+)>(CTREncrypt<BlockSize, KeySize>);
+
+// Потоковое шифрование в режиме CTR. Данные подаются порциями
+// произвольной длины, неиспользованная часть гаммы переносится
+// между вызовами. Результат совпадает с CTREncrypt над всем потоком.
+// precompute() заранее вырабатывает до CTRBatchBlocks блоков гаммы
+// с текущей позиции, чтобы короткие сообщения шифровались без
+// обращения к шифру.
+template <IsCipher CipherType>
+class CTRStream {
+private:
+    static constexpr size_t BlockSize = CipherType::BlockSize;
 
-#endif
\ No newline at end of file
+    const CipherType &cipher_;
+    const SecureBuffer<BlockSize> IV_;
+    SecureBuffer<BlockSize * CTRBatchBlocks> keystream_;
+    uint64_t keystream_first_;
+    size_t keystream_blocks_;
+    uint64_t position_;
+public:
+    inline CTRStream(const CipherType &cipher, const uint8_t (&IV)[BlockSize]) noexcept
+        : cipher_(cipher), IV_(IV), keystream_first_(0), keystream_blocks_(0), position_(0) {}
+    // in и out могут совпадать.
+    void update(const uint8_t *in, uint8_t *out, size_t len);
+    void precompute();
+    inline void seek(const uint64_t offset) noexcept { position_ = offset; }
+    inline uint64_t tell() const noexcept { return position_; }
+};
+
+template <IsCipher CipherType>
+void CTRStream<CipherType>::precompute() {
+    keystream_first_ = position_ / BlockSize;
+    keystream_blocks_ = CTRBatchBlocks;
+    CTRCounters<BlockSize>(keystream_.raw(), IV_.raw(), keystream_first_, CTRBatchBlocks);
+    cipher_.encryptBlocks(keystream_.raw(), CTRBatchBlocks);
+}
+
+template <IsCipher CipherType>
+void CTRStream<CipherType>::update(const uint8_t *in, uint8_t *out, size_t len) {
+    while (len) {
+        // Разность беззнаковая: позиция левее кэша даёт большое число.
+        const uint64_t cached = position_ / BlockSize - keystream_first_;
+        if (cached < keystream_blocks_) {
+            const size_t offset = static_cast<size_t>(position_ - keystream_first_ * BlockSize);
+            const size_t n = std::min(len, keystream_blocks_ * BlockSize - offset);
+            xorBytes(out, in, keystream_.raw() + offset, n);
+            in += n; out += n; len -= n; position_ += n;
+            continue;
+        }
+        const size_t num_of_blocks = position_ % BlockSize ? 0 : len / BlockSize;
+        if (num_of_blocks) {
+            CTRBlocks(cipher_, IV_.raw(), position_ / BlockSize, in, out, num_of_blocks);
+            in += num_of_blocks * BlockSize; out += num_of_blocks * BlockSize;
+            len -= num_of_blocks * BlockSize; position_ += num_of_blocks * BlockSize;
+            continue;
+        }
+        precompute();
+    }
+}
+
+#endif
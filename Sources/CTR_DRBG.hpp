@@ -3,13 +3,8 @@
 
 #include <fstream>
 
-#ifndef DONT_USE_TBB
-#include <tbb/parallel_for.h>
-#include <tbb/blocked_range.h>
-#endif
-
-#define SECUREBUFFER_BIG_ENDIAN_COUNTER
 #include "Cipher.hpp"
+#include "ParallelPolicy.hpp"
 #include "Hash.hpp"
 #include "EntropySource.hpp"
 
@@ -30,16 +25,16 @@ template <
     IsCipher CipherType,
     bool AutoReseed = false,
     IsEntropySource<CipherType::BlockSize + CipherType::KeySize> EntropySourceType =
-        Urandom<CipherType::BlockSize + CipherType::KeySize>
+        GetrandomSource<CipherType::BlockSize + CipherType::KeySize>
 >
 class CTR_DRBG {
-private:
+public:
     static constexpr size_t SeedLen = CipherType::BlockSize + CipherType::KeySize;
     static constexpr size_t MaxBytesPerRequest =
         CipherType::BlockSize < 16 ? (static_cast<size_t>(1) << 10) : (static_cast<size_t>(1) << 16);
     static constexpr size_t ReseedInterval =
         CipherType::BlockSize < 16 ? (static_cast<size_t>(1) << 32) : (static_cast<size_t>(1) << 48);
-
+private:
     const EntropySourceType entropy_source_;
     SecureBuffer<CipherType::BlockSize> state_;
     size_t reseed_counter_;
@@ -93,13 +88,13 @@ void CTR_DRBG<CipherType, AutoReseed, EntropySourceType>::update(const SecureBuf
     SecureBuffer<SeedLen> temp;
     SecureBuffer<CipherType::BlockSize> block;
     for (size_t i = 0; i < num_of_blocks; ++i) {
-        state_.add(1);
+        state_.template add<std::endian::big>(1);
         block = state_;
         cipher_.encrypt(block);
         std::copy(block.begin(), block.end(), temp.begin() + i * CipherType::BlockSize);
     }
     if constexpr (remainder > 0) {
-        state_.add(1);
+        state_.template add<std::endian::big>(1);
         block = state_;
         cipher_.encrypt(block);
         std::copy(block.begin(), block.begin() + remainder,
@@ -138,29 +133,18 @@ void CTR_DRBG<CipherType, AutoReseed, EntropySourceType>::operator()(
     }
     size_t num_of_blocks = size / CipherType::BlockSize;
     size_t remainder = size % CipherType::BlockSize;
-    #ifndef DONT_USE_TBB
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_of_blocks, 128),
-    [&](const tbb::blocked_range<size_t>& r) {
+    ParallelPolicy::forBlocks(num_of_blocks, [&](const size_t begin, const size_t end) {
         SecureBuffer<CipherType::BlockSize> block;
-        for (size_t i = r.begin(); i != r.end(); ++i) {
+        for (size_t i = begin; i != end; ++i) {
             block = state_;
-            block.add(i + 1);
+            block.template add<std::endian::big>(i + 1);
             cipher_.encrypt(block);
             memcpy(buffer + i * CipherType::BlockSize, block.raw(), CipherType::BlockSize);
         }
     });
-    state_.add(num_of_blocks);
-    #else
-    SecureBuffer<CipherType::BlockSize> block;
-    for (size_t i = 0; i < num_of_blocks; ++i) {
-        state_.add(1);
-        block = state_;
-        cipher_.encrypt(block);
-        memcpy(buffer + i * CipherType::BlockSize, block.raw(), CipherType::BlockSize);
-    }
-    #endif
+    state_.template add<std::endian::big>(num_of_blocks);
     if (remainder > 0) {
-        state_.add(1);
+        state_.template add<std::endian::big>(1);
         SecureBuffer<CipherType::BlockSize> block(state_);
         cipher_.encrypt(block);
         memcpy(buffer + (size - remainder), block.raw(), remainder);
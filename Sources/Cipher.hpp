@@ -9,6 +9,15 @@ public:
     virtual void initKeySchedule(const SecureBuffer<KeySize> &key) = 0;
     virtual SecureBuffer<BlockSize> &encrypt(SecureBuffer<BlockSize> &) const = 0;
     virtual SecureBuffer<BlockSize> &decrypt(SecureBuffer<BlockSize> &) const = 0;
+    // Шифрование count подряд идущих блоков на месте.
+    virtual void encryptBlocks(uint8_t *blocks, const size_t count) const {
+        SecureBuffer<BlockSize> block;
+        for (size_t i = 0; i < count; ++i) {
+            memcpy(block.raw(), blocks + i * BlockSize, BlockSize);
+            encrypt(block);
+            memcpy(blocks + i * BlockSize, block.raw(), BlockSize);
+        }
+    }
     virtual ~Cipher() = default;
 };
 
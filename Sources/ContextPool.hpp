@@ -0,0 +1,61 @@
+/*  Пул переиспользуемых криптографических контекстов (MAC, KDF, шифров).
+    Контексты создаются один раз на поток и далее только перенастраиваются
+    через init()/initKeySchedule(), поэтому mlock/munlock их буферов
+    не выполняются на каждое сообщение. При возврате в пул ключевой
+    материал контекста стирается (wipe()).
+*/
+#ifndef CONTEXT_POOL_HPP
+#define CONTEXT_POOL_HPP
+
+#include <memory>
+#include <vector>
+
+template <typename Context>
+requires requires(Context &ctx) { { ctx.wipe() } noexcept; }
+class ContextPool {
+private:
+    std::vector<std::unique_ptr<Context>> free_;
+    size_t created_ = 0;
+public:
+    class Lease {
+    private:
+        ContextPool &pool_;
+        std::unique_ptr<Context> ctx_;
+    public:
+        inline Lease(ContextPool &pool, std::unique_ptr<Context> ctx) noexcept
+            : pool_(pool), ctx_(std::move(ctx)) {}
+        Lease(const Lease &) = delete;
+        Lease &operator=(const Lease &) = delete;
+        inline ~Lease() {
+            ctx_->wipe();
+            pool_.free_.push_back(std::move(ctx_));
+        }
+        inline Context &operator*() const noexcept { return *ctx_; }
+        inline Context *operator->() const noexcept { return ctx_.get(); }
+    };
+
+    ContextPool() = default;
+    ContextPool(const ContextPool &) = delete;
+    ContextPool &operator=(const ContextPool &) = delete;
+
+    // Контекст выдаётся со стёртым ключом, перед работой его
+    // необходимо перенастроить.
+    inline Lease acquire() {
+        if (free_.empty()) {
+            // Резервируем место заранее, чтобы возврат в пул не выделял память.
+            free_.reserve(++created_);
+            return Lease(*this, std::make_unique<Context>());
+        }
+        std::unique_ptr<Context> ctx = std::move(free_.back());
+        free_.pop_back();
+        return Lease(*this, std::move(ctx));
+    }
+    inline size_t available() const noexcept { return free_.size(); }
+
+    inline static ContextPool &local() {
+        thread_local ContextPool pool;
+        return pool;
+    }
+};
+
+#endif
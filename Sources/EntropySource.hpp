@@ -2,6 +2,13 @@
 #define ENTROPYSOURCE_HPP
 
 #include <fstream>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/random.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 #include "SecureBuffer.hpp"
 #include "CRISPExceptions.hpp"
 
@@ -26,6 +33,76 @@ public:
     }
 };
 
+// Чтение из /dev/urandom через дескриптор, открытый один раз на процесс.
+// Используется, только если ядро не поддерживает getrandom().
+inline void urandomFallbackFill(uint8_t *buffer, size_t size) {
+    static const int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw crispex::lack_of_entropy("Не удалось получить доступ к /dev/urandom.");
+    while (size) {
+        const ssize_t got = read(fd, buffer, size);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) throw crispex::lack_of_entropy("Не удалось получить энтропию из /dev/urandom.");
+        buffer += got; size -= static_cast<size_t>(got);
+    }
+}
+
+inline void getrandomFill(uint8_t *buffer, size_t size) {
+    while (size) {
+        const ssize_t got = getrandom(buffer, size, 0);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            if (errno == ENOSYS) { urandomFallbackFill(buffer, size); return; }
+            throw crispex::lack_of_entropy("Не удалось получить энтропию через getrandom().");
+        }
+        buffer += got; size -= static_cast<size_t>(got);
+    }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("rdseed,rdrnd")))
+inline bool hardwareRandom64(uint64_t &value, const bool use_rdseed) noexcept {
+    unsigned long long result;
+    for (int attempt = 0; attempt < 10; ++attempt)
+        if (use_rdseed ? _rdseed64_step(&result) : _rdrand64_step(&result)) {
+            value = result;
+            return true;
+        }
+    return false;
+}
+#endif
+
+// Сложение по модулю 2 с выходом RDSEED (или RDRAND, если RDSEED нет).
+// Источники независимы, поэтому смешивание не уменьшает энтропию
+// getrandom(). При отказе инструкции байты остаются без изменений.
+inline void hardwareMix(uint8_t *buffer, const size_t size) noexcept {
+#if defined(__x86_64__)
+    static const bool has_rdseed = __builtin_cpu_supports("rdseed");
+    static const bool has_rdrand = __builtin_cpu_supports("rdrnd");
+    if (!has_rdseed && !has_rdrand) return;
+    for (size_t i = 0; i < size; i += 8) {
+        uint64_t value;
+        if (!hardwareRandom64(value, has_rdseed)) return;
+        xorBytes(buffer + i, reinterpret_cast<const uint8_t *>(&value), std::min<size_t>(8, size - i));
+    }
+#else
+    (void)buffer; (void)size;
+#endif
+}
+
+// Источник на системном вызове getrandom(): без открытия файлов
+// и выделения памяти на каждое пересеивание.
+template <size_t SeedLen, bool HardwareMix = true>
+class GetrandomSource : public EntropySource<SeedLen> {
+public:
+    SecureBuffer<SeedLen> operator()() const override {
+        SecureBuffer<SeedLen> entropy;
+        getrandomFill(entropy.raw(), SeedLen);
+        if constexpr (HardwareMix) hardwareMix(entropy.raw(), SeedLen);
+        LOG(INFO) << "Обращение к getrandom";
+        return entropy;
+    }
+};
+
 template <typename T, size_t SeedLen>
 concept IsEntropySource = requires {
     { T() };
@@ -21,6 +21,8 @@ public:
     std::vector<uint8_t> digest() noexcept override;
     void digest(uint8_t *digest_buffer) noexcept override;
     void clear() noexcept override;
+    // Стирание ключа и состояния; до initKeySchedule контекст непригоден.
+    inline void wipe() noexcept { hash_.clear(); secureWipe(padded_key_.raw(), HashType::BlockSize); }
 
     static constexpr size_t BlockSize = HashType::BlockSize;
     static constexpr size_t DigestSize = HashType::DigestSize;
@@ -31,6 +33,7 @@ template <IsHash HashType, size_t KeyLen>
 void HMAC<HashType, KeyLen>::initKeySchedule(const SecureBuffer<KeyLen> &key) noexcept {
     static_assert(HashType::DigestSize <= HashType::BlockSize,
         "Размер подписи базового хэша не может быть больше его размера блока.");
+    hash_.clear();
     padded_key_.zero();
     if constexpr (KeyLen > HashType::BlockSize) {
         hash_.update(key.raw(), KeyLen);
@@ -3,8 +3,40 @@
 
 #include <endian.h>
 #include <memory>
+#include <span>
 #include "Hash.hpp"
 
+#ifdef KDF_PROFILE
+#include <atomic>
+#include <chrono>
+
+// Суммарное время фаз выработки во всех объектах KDF, в наносекундах.
+// Заполняется только при сборке с KDF_PROFILE (цель Lab2Profile).
+struct KDFPhaseTimes {
+    std::atomic<int64_t> init_ns = 0;
+    std::atomic<int64_t> format_ns = 0;
+    std::atomic<int64_t> mac_ns = 0;
+};
+inline KDFPhaseTimes kdf_phase_times;
+
+// Добавляет время своей жизни к счётчику фазы.
+class KDFPhaseTimer {
+private:
+    std::atomic<int64_t> &phase_ns_;
+    const std::chrono::steady_clock::time_point start_;
+public:
+    inline explicit KDFPhaseTimer(std::atomic<int64_t> &phase_ns) noexcept
+        : phase_ns_(phase_ns), start_(std::chrono::steady_clock::now()) {}
+    inline ~KDFPhaseTimer() {
+        const auto elapsed = std::chrono::steady_clock::now() - start_;
+        phase_ns_.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+            std::memory_order_relaxed
+        );
+    }
+};
+#endif
+
 template <IsMAC InnerMAC, IsMAC OuterMAC, size_t MasterKeySize>
 requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
 class KDF_R_13235651022 {
@@ -13,6 +45,8 @@ private:
 public:
     KDF_R_13235651022() = default;
     inline ~KDF_R_13235651022() { LOG(INFO) << "Промежуточный ключ KDF очищен из памяти"; }
+    // Стирание промежуточного ключа; до init() объект непригоден.
+    inline void wipe() noexcept { outer_mac_.wipe(); }
     void init(
         const SecureBuffer<MasterKeySize> &master_key,
         const SecureBuffer<InnerMAC::KeySize> &salt
@@ -28,24 +62,80 @@ public:
         const uint8_t (&user_info)[16],
         const uint8_t (&additional_info)[16]
     ) noexcept;
+
+    // Потоковая выработка: та же последовательность, что и у fetch,
+    // но выдаётся порциями произвольного размера при постоянном объёме памяти.
+    // Длина всё равно объявляется заранее, так как входит в формат.
+    // Генератор использует внешний MAC объекта KDF, поэтому одновременно
+    // может существовать только один генератор на объект.
+    class Generator;
+    inline Generator stream(
+        const uint64_t size,
+        const uint8_t (&IV)[OuterMAC::DigestSize],
+        const uint8_t (&application_info)[32],
+        const uint8_t (&user_info)[16],
+        const uint8_t (&additional_info)[16]
+    ) noexcept { return Generator(outer_mac_, size, IV, application_info, user_info, additional_info); }
 };
 
 template <IsMAC InnerMAC, IsMAC OuterMAC, size_t MasterKeySize>
 requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
-void KDF_R_13235651022<InnerMAC, OuterMAC, MasterKeySize>::init(
+class KDF_R_13235651022<InnerMAC, OuterMAC, MasterKeySize>::Generator {
+private:
+    OuterMAC &mac_;
+    SecureBuffer<OuterMAC::DigestSize + 81> format_;
+    SecureBuffer<OuterMAC::DigestSize> current_state_;
+    uint64_t counter_;
+    size_t used_;
+    uint64_t remaining_;
+
+    void nextBlock() noexcept;
+public:
+    Generator(
+        OuterMAC &mac, const uint64_t size,
+        const uint8_t (&IV)[OuterMAC::DigestSize],
+        const uint8_t (&application_info)[32],
+        const uint8_t (&user_info)[16],
+        const uint8_t (&additional_info)[16]
+    ) noexcept;
+    Generator(const Generator &) = delete;
+    Generator &operator=(const Generator &) = delete;
+    inline ~Generator() { mac_.clear(); }
+    // Возвращает число записанных байт. Меньше out.size() только
+    // если объявленная длина исчерпана.
+    size_t next(std::span<uint8_t> out) noexcept;
+    inline uint64_t remaining() const noexcept { return remaining_; }
+};
+
+template <IsMAC InnerMAC, size_t InnerKeySize, size_t MasterKeySize>
+requires (InnerMAC::DigestSize >= InnerKeySize)
+inline static void deriveInnerKey(
+    SecureBuffer<InnerKeySize> &inner_key,
     const SecureBuffer<MasterKeySize> &master_key,
     const SecureBuffer<InnerMAC::KeySize> &salt
 ) noexcept {
-    SecureBuffer<OuterMAC::KeySize> inner_key;
     InnerMAC mac(salt);
     mac.update(master_key.raw(), MasterKeySize);
-    if constexpr (InnerMAC::DigestSize == OuterMAC::KeySize) mac.digest(inner_key.raw());
+    if constexpr (InnerMAC::DigestSize == InnerKeySize) mac.digest(inner_key.raw());
     else {
         SecureBuffer<InnerMAC::DigestSize> big_inner_key;
         mac.digest(big_inner_key.raw());
-        std::copy(big_inner_key.begin(), big_inner_key.begin() + OuterMAC::KeySize, inner_key.begin());
+        std::copy(big_inner_key.begin(), big_inner_key.begin() + InnerKeySize, inner_key.begin());
     }
     LOG(INFO) << "Выработан промежуточный ключ KDF";
+}
+
+template <IsMAC InnerMAC, IsMAC OuterMAC, size_t MasterKeySize>
+requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
+void KDF_R_13235651022<InnerMAC, OuterMAC, MasterKeySize>::init(
+    const SecureBuffer<MasterKeySize> &master_key,
+    const SecureBuffer<InnerMAC::KeySize> &salt
+) noexcept {
+#ifdef KDF_PROFILE
+    const KDFPhaseTimer timer(kdf_phase_times.init_ns);
+#endif
+    SecureBuffer<OuterMAC::KeySize> inner_key;
+    deriveInnerKey<InnerMAC>(inner_key, master_key, salt);
     outer_mac_.initKeySchedule(inner_key);
 }
 
@@ -57,6 +147,9 @@ inline static SecureBuffer<DigestSize + 81> getFormat(
     const uint8_t (&additional_info)[16],
     uint64_t size
 ) {
+#ifdef KDF_PROFILE
+    const KDFPhaseTimer timer(kdf_phase_times.format_ns);
+#endif
     SecureBuffer<DigestSize + 81> format;
     format[0] = 0xFC;
     uint64_t counter = htole64(1);
@@ -76,6 +169,9 @@ inline static SecureBuffer<DigestSize + 81> &updateFormat(
     const SecureBuffer<DigestSize> &current_state,
     uint64_t counter
 ) {
+#ifdef KDF_PROFILE
+    const KDFPhaseTimer timer(kdf_phase_times.format_ns);
+#endif
     counter = htole64(counter);
     memcpy(format.raw() + 1, &counter, 8);
     std::copy(
@@ -96,25 +192,53 @@ void KDF_R_13235651022<InnerMAC, OuterMAC, MasterKeySize>::fetch(
     const uint8_t (&additional_info)[16]
 ) noexcept {
     LOG(INFO) << "Запрошена выработка информации размером " << size << " байт";
-    SecureBuffer<OuterMAC::DigestSize + 81> format =
-        getFormat(IV, application_info, user_info, additional_info, size);
-    SecureBuffer<OuterMAC::DigestSize> current_state;
-    const size_t full_blocks = size / OuterMAC::DigestSize;
-    const size_t remainder = size % OuterMAC::DigestSize;
-    for (size_t counter = 0; counter < full_blocks; ++counter) {
-        outer_mac_.update(format.raw(), OuterMAC::DigestSize + 81);
-        outer_mac_.digest(current_state.raw());
-        outer_mac_.clear();
-        memcpy(key + counter * OuterMAC::DigestSize, current_state.raw(), OuterMAC::DigestSize);
-        updateFormat(format, current_state, counter + 2);
-    }
-    if (remainder > 0) {
-        outer_mac_.update(format.raw(), OuterMAC::DigestSize + 81);
-        outer_mac_.digest(current_state.raw());
-        memcpy(key + (size - remainder), current_state.raw(), remainder);
-    }
+    stream(size, IV, application_info, user_info, additional_info).next(std::span<uint8_t>(key, size));
     LOG(INFO) << "Выработана производная ключевая информация размером " << size << " байт";
-    outer_mac_.clear();
+}
+
+template <IsMAC InnerMAC, IsMAC OuterMAC, size_t MasterKeySize>
+requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
+KDF_R_13235651022<InnerMAC, OuterMAC, MasterKeySize>::Generator::Generator(
+    OuterMAC &mac, const uint64_t size,
+    const uint8_t (&IV)[OuterMAC::DigestSize],
+    const uint8_t (&application_info)[32],
+    const uint8_t (&user_info)[16],
+    const uint8_t (&additional_info)[16]
+) noexcept :
+    mac_(mac),
+    format_(getFormat(IV, application_info, user_info, additional_info, size)),
+    counter_(1),
+    used_(OuterMAC::DigestSize),
+    remaining_(size) {}
+
+template <IsMAC InnerMAC, IsMAC OuterMAC, size_t MasterKeySize>
+requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
+void KDF_R_13235651022<InnerMAC, OuterMAC, MasterKeySize>::Generator::nextBlock() noexcept {
+    if (counter_ > 1) updateFormat(format_, current_state_, counter_);
+#ifdef KDF_PROFILE
+    const KDFPhaseTimer timer(kdf_phase_times.mac_ns);
+#endif
+    mac_.update(format_.raw(), OuterMAC::DigestSize + 81);
+    mac_.digest(current_state_.raw());
+    mac_.clear();
+    ++counter_;
+    used_ = 0;
+}
+
+template <IsMAC InnerMAC, IsMAC OuterMAC, size_t MasterKeySize>
+requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
+size_t KDF_R_13235651022<InnerMAC, OuterMAC, MasterKeySize>::Generator::next(std::span<uint8_t> out) noexcept {
+    const size_t size = static_cast<size_t>(std::min<uint64_t>(out.size(), remaining_));
+    size_t written = 0;
+    while (written < size) {
+        if (used_ == OuterMAC::DigestSize) nextBlock();
+        const size_t to_copy = std::min(OuterMAC::DigestSize - used_, size - written);
+        memcpy(out.data() + written, current_state_.raw() + used_, to_copy);
+        used_ += to_copy;
+        written += to_copy;
+    }
+    remaining_ -= size;
+    return size;
 }
 
 #endif
\ No newline at end of file
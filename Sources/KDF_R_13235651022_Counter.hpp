@@ -0,0 +1,99 @@
+/*  Вариант KDF из Р 1323565.1.022—2018 в режиме счётчика
+    (аналог counter mode из NIST SP 800-108). В отличие от
+    KDF_R_13235651022 выход предыдущего блока не подставляется
+    в формат следующего: IV остаётся неизменным, меняется только
+    счётчик. Блоки независимы и вырабатываются параллельно.
+*/
+#ifndef KDF_R_13235651022_COUNTER_HPP
+#define KDF_R_13235651022_COUNTER_HPP
+
+#ifndef DONT_USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#include "KDF_R_13235651022.hpp"
+
+template <IsMAC InnerMAC, IsMAC OuterMAC, size_t MasterKeySize>
+requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
+class KDF_R_13235651022_Counter {
+private:
+    SecureBuffer<OuterMAC::KeySize> inner_key_;
+
+    void fetchBlocks(
+        uint8_t *key, const uint64_t size,
+        const SecureBuffer<OuterMAC::DigestSize + 81> &format,
+        const size_t begin, const size_t end
+    ) const noexcept;
+public:
+    KDF_R_13235651022_Counter() = default;
+    inline ~KDF_R_13235651022_Counter() { LOG(INFO) << "Промежуточный ключ KDF очищен из памяти"; }
+    inline void init(
+        const SecureBuffer<MasterKeySize> &master_key,
+        const SecureBuffer<InnerMAC::KeySize> &salt
+    ) noexcept { deriveInnerKey<InnerMAC>(inner_key_, master_key, salt); }
+    inline KDF_R_13235651022_Counter(
+        const SecureBuffer<MasterKeySize> &master_key,
+        const SecureBuffer<InnerMAC::KeySize> &salt
+    ) noexcept { init(master_key, salt); }
+    void fetch(
+        uint8_t *key, const uint64_t size,
+        const uint8_t (&IV)[OuterMAC::DigestSize],
+        const uint8_t (&application_info)[32],
+        const uint8_t (&user_info)[16],
+        const uint8_t (&additional_info)[16]
+    ) const noexcept;
+};
+
+template <IsMAC InnerMAC, IsMAC OuterMAC, size_t MasterKeySize>
+requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
+void KDF_R_13235651022_Counter<InnerMAC, OuterMAC, MasterKeySize>::fetchBlocks(
+    uint8_t *key, const uint64_t size,
+    const SecureBuffer<OuterMAC::DigestSize + 81> &format,
+    const size_t begin, const size_t end
+) const noexcept {
+    // Потоковые MAC (HMAC, NMAC) не копируются, поэтому каждый
+    // диапазон блоков получает собственный контекст.
+    OuterMAC mac(inner_key_);
+    SecureBuffer<OuterMAC::DigestSize + 81> local_format(format);
+    SecureBuffer<OuterMAC::DigestSize> block;
+    for (size_t i = begin; i != end; ++i) {
+        uint64_t counter = htole64(static_cast<uint64_t>(i) + 1);
+        memcpy(local_format.raw() + 1, &counter, 8);
+        mac.update(local_format.raw(), OuterMAC::DigestSize + 81);
+        const size_t offset = i * OuterMAC::DigestSize;
+        if (size - offset >= OuterMAC::DigestSize)
+            mac.digest(key + offset);
+        else {
+            mac.digest(block.raw());
+            memcpy(key + offset, block.raw(), size - offset);
+        }
+        mac.clear();
+    }
+}
+
+template <IsMAC InnerMAC, IsMAC OuterMAC, size_t MasterKeySize>
+requires (InnerMAC::DigestSize >= OuterMAC::KeySize)
+void KDF_R_13235651022_Counter<InnerMAC, OuterMAC, MasterKeySize>::fetch(
+    uint8_t *key, const uint64_t size,
+    const uint8_t (&IV)[OuterMAC::DigestSize],
+    const uint8_t (&application_info)[32],
+    const uint8_t (&user_info)[16],
+    const uint8_t (&additional_info)[16]
+) const noexcept {
+    LOG(INFO) << "Запрошена выработка информации размером " << size << " байт в режиме счётчика";
+    const SecureBuffer<OuterMAC::DigestSize + 81> format =
+        getFormat(IV, application_info, user_info, additional_info, size);
+    const size_t num_of_blocks = (size + OuterMAC::DigestSize - 1) / OuterMAC::DigestSize;
+#ifndef DONT_USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_of_blocks, 16),
+    [&](const tbb::blocked_range<size_t>& r) {
+        fetchBlocks(key, size, format, r.begin(), r.end());
+    });
+#else
+    fetchBlocks(key, size, format, 0, num_of_blocks);
+#endif
+    LOG(INFO) << "Выработана производная ключевая информация размером " << size << " байт";
+}
+
+#endif
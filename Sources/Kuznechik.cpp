@@ -37,7 +37,7 @@ static constexpr uint8_t Sbox[] = {
      89, 166, 116, 210, 230, 244, 180, 192, 209, 102, 175, 194,  57,  75,  99, 182
 };
 
-static inline SecureBuffer<16> &substitute(SecureBuffer<16> &vector) noexcept {
+static inline Block128 &substitute(Block128 &vector) noexcept {
     for (uint8_t i = 0; i < 16; ++i) vector[i] = Sbox[vector[i]];
     return vector;
 }
@@ -61,12 +61,12 @@ static constexpr uint8_t invSbox[] = {
      18,  26,  72, 104, 245, 129, 139, 199, 214,  32,  10,   8,   0,  76, 215, 116
 };
 
-static inline SecureBuffer<16> &inverseSubstitute(SecureBuffer<16> &vector) noexcept {
+static inline Block128 &inverseSubstitute(Block128 &vector) noexcept {
     for (uint8_t i = 0; i < 16; ++i) vector[i] = invSbox[vector[i]];
     return vector;
 }
 
-static inline SecureBuffer<16> &linear(SecureBuffer<16> &vector) noexcept {
+static inline Block128 &linear(Block128 &vector) noexcept {
     for (uint8_t i = 0; i < 16; ++i)
         vector[15 - i] =
             mul_table[0][vector[static_cast<size_t>((16 - i)  % 16)]] ^
@@ -88,7 +88,7 @@ static inline SecureBuffer<16> &linear(SecureBuffer<16> &vector) noexcept {
     return vector;
 }
 
-static inline SecureBuffer<16> &inverseLinear(SecureBuffer<16> &vector) noexcept {
+static inline Block128 &inverseLinear(Block128 &vector) noexcept {
     for (uint8_t i = 0; i < 16; ++i) {
         vector[i] =
             mul_table[0][vector[static_cast<size_t>((i + 1) % 16)]]  ^
@@ -112,12 +112,12 @@ static inline SecureBuffer<16> &inverseLinear(SecureBuffer<16> &vector) noexcept
 }
 
 static inline void Feistel(
-    SecureBuffer<16> &a1,
-    SecureBuffer<16> &a0,
+    Block128 &a1,
+    Block128 &a0,
     const uint8_t (&const_round_key)[16]
 ) noexcept {
-    SecureBuffer<16> a1_copy(a1);
-    linear(substitute(a1 += const_round_key)) += a0;
+    const Block128 a1_copy = a1;
+    linear(substitute(a1.xorFrom(const_round_key))) ^= a0;
     a0 = a1_copy;
 }
 
@@ -158,50 +158,88 @@ static constexpr uint8_t const_keys[32][16] = {
 
 void Kuznechik::initKeySchedule(const SecureBuffer<32> &key) noexcept {
     LOG(INFO) << "Начата выработка раундовых ключей Кузнечика";
-    std::copy(key.begin(), key.begin() + 16, key_schedule_[0].begin());
-    std::copy(key.begin() + 16, key.end(), key_schedule_[1].begin());
+    Block128 a1 = Block128::load(key.raw());
+    Block128 a0 = Block128::load(key.raw() + 16);
+    a1.store(key_schedule_.raw());
+    a0.store(key_schedule_.raw() + 16);
     for (uint8_t i = 1; i <= 4; ++i) {
-        key_schedule_[2 * i] = key_schedule_[2 * i - 2];
-        key_schedule_[2 * i + 1] = key_schedule_[2 * i - 1];
         for (uint8_t j = 0; j < 8; ++j)
-            Feistel(key_schedule_[2 * i], key_schedule_[2 * i + 1], const_keys[8 * (i - 1) + j]);
+            Feistel(a1, a0, const_keys[8 * (i - 1) + j]);
+        a1.store(key_schedule_.raw() + 32 * i);
+        a0.store(key_schedule_.raw() + 32 * i + 16);
     }
+    a1.wipe();
+    a0.wipe();
 }
 
-SecureBuffer<16> &Kuznechik::encrypt(SecureBuffer<16> &plain_text) const noexcept {
+void Kuznechik::encryptBlock(Block128 &block) const noexcept {
     for (uint8_t i = 0; i < 9; ++i)
-        linear(substitute(plain_text += key_schedule_[i]));
-    plain_text += key_schedule_[9];
+        linear(substitute(block.xorFrom(roundKey(i))));
+    block.xorFrom(roundKey(9));
+}
+
+void Kuznechik::decryptBlock(Block128 &block) const noexcept {
+    for (uint8_t i = 9; i > 0; --i)
+        inverseSubstitute(inverseLinear(block.xorFrom(roundKey(i))));
+    block.xorFrom(roundKey(0));
+}
+
+SecureBuffer<16> &Kuznechik::encrypt(SecureBuffer<16> &plain_text) const noexcept {
+    Block128 block = Block128::load(plain_text);
+    encryptBlock(block);
+    block.store(plain_text);
+    block.wipe();
     return plain_text;
 }
 
 SecureBuffer<16> &Kuznechik::decrypt(SecureBuffer<16> &encrypted_text) const noexcept {
-    for (uint8_t i = 9; i > 0; --i)
-        inverseSubstitute(inverseLinear(encrypted_text += key_schedule_[i]));
-    encrypted_text += key_schedule_[0];
+    Block128 block = Block128::load(encrypted_text);
+    decryptBlock(block);
+    block.store(encrypted_text);
+    block.wipe();
     return encrypted_text;
 }
 
+void Kuznechik::encryptBlocks(uint8_t *blocks, const size_t count) const noexcept {
+    Block128 block;
+    for (size_t i = 0; i < count; ++i) {
+        block = Block128::load(blocks + i * 16);
+        encryptBlock(block);
+        block.store(blocks + i * 16);
+    }
+    block.wipe();
+}
+
 #ifdef UNIT_TESTS
 
 SecureBuffer<16> &testSubstitute(SecureBuffer<16> &vector) noexcept {
-    return substitute(vector);
+    Block128 block = Block128::load(vector);
+    substitute(block).store(vector);
+    return vector;
 }
 
 SecureBuffer<16> &testInverseSubstitute(SecureBuffer<16> &vector) noexcept {
-    return inverseSubstitute(vector);
+    Block128 block = Block128::load(vector);
+    inverseSubstitute(block).store(vector);
+    return vector;
 }
 
 SecureBuffer<16> &testLinear(SecureBuffer<16> &vector) noexcept {
-    return linear(vector);
+    Block128 block = Block128::load(vector);
+    linear(block).store(vector);
+    return vector;
 }
 
 SecureBuffer<16> &testInverseLinear(SecureBuffer<16> &vector) noexcept {
-    return inverseLinear(vector);
+    Block128 block = Block128::load(vector);
+    inverseLinear(block).store(vector);
+    return vector;
 }
 
-const SecureBuffer<16> *Kuznechik::getKeySchedule() const noexcept {
-    return key_schedule_;
+std::array<SecureBuffer<16>, 10> Kuznechik::getKeySchedule() const {
+    std::array<SecureBuffer<16>, 10> round_keys;
+    for (size_t i = 0; i < 10; ++i) memcpy(round_keys[i].raw(), roundKey(i), 16);
+    return round_keys;
 }
 
 #endif
\ No newline at end of file
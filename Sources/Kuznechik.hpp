@@ -1,11 +1,19 @@
 #ifndef KUZNECHIK_HPP
 #define KUZNECHIK_HPP
 
+#include <array>
 #include "Cipher.hpp"
+#include "Block128.hpp"
 
 class Kuznechik final : public Cipher<16, 32> {
 private:
-    SecureBuffer<16> key_schedule_[10];
+    // Раундовые ключи подряд в одной ячейке арены: она выровнена на
+    // строку кэша и размещается на узле NUMA создающего потока.
+    SecureBuffer<160> key_schedule_;
+    static_assert(LockedArena::alignment(160) % LockedArena::CacheLine == 0);
+
+    inline const uint8_t *roundKey(const size_t i) const noexcept
+        { return key_schedule_.raw() + 16 * i; }
 public:
     static constexpr size_t BlockSize = 16;
     static constexpr size_t KeySize = 32;
@@ -16,9 +24,16 @@ public:
         { initKeySchedule(key); }
     SecureBuffer<16> &encrypt(SecureBuffer<16> &plain_text) const noexcept override;
     SecureBuffer<16> &decrypt(SecureBuffer<16> &encrypted_text) const noexcept override;
+    void encryptBlocks(uint8_t *blocks, const size_t count) const noexcept override;
+    // Раундовые преобразования над блоком в регистрах. Блок не затирается:
+    // это делает вызывающий после обработки всех своих блоков.
+    void encryptBlock(Block128 &block) const noexcept;
+    void decryptBlock(Block128 &block) const noexcept;
+    // Стирание раундовых ключей; до initKeySchedule шифр непригоден.
+    inline void wipe() noexcept { secureWipe(key_schedule_.raw(), 160); }
     inline ~Kuznechik() { LOG(INFO) << "Раундовые ключи Кузнечика очищены из памяти"; }
     #ifdef UNIT_TESTS
-        const SecureBuffer<16> *getKeySchedule() const noexcept;
+        std::array<SecureBuffer<16>, 10> getKeySchedule() const;
     #endif
 };
 
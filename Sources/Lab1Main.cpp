@@ -7,12 +7,13 @@ INITIALIZE_EASYLOGGINGPP
 
 int main(int argc, char **argv) {
     confLog(false, true, "lab.log");
+    std::atexit(logSecureBufferStats);
     if (argc < 3) {
         std::cout << "Запускать: " << argv[0] << " <файл_ключа> <файл_с_текстом> [ожидаемый MAC в hex]" << std::endl;
         return -1;
     }
     try {
-        const std::vector<uint8_t> expected_mac = (argc < 4) ? std::vector<uint8_t>{} : parseHexString(argv[3]); 
+        const SecureVector expected_mac = (argc < 4) ? SecureVector{} : parseHexString(argv[3]); 
         OMAC<Kuznechik> ctx;
         initKuznechikOMACCTX(ctx, argv[1]);
         std::ifstream file(argv[2], std::ios::binary);
@@ -263,6 +263,7 @@ int getOrCheckFileMac(const Params &params) {
 
 int main(int argc, char **argv) {
     confLog(false, true, "lab.log");
+    std::atexit(logSecureBufferStats);
     Params params;
     if (getParams(params, argc, argv))
         return -1;
@@ -1,6 +1,10 @@
 #include <unistd.h>
+#include <fcntl.h>
 #include <iostream>
 #include <iomanip>
+#ifndef DONT_USE_TBB
+#include <tbb/parallel_pipeline.h>
+#endif
 #include "Kuznechik.hpp"
 #include "CTR_DRBG.hpp"
 #include "Utils.hpp"
@@ -9,13 +13,22 @@ INITIALIZE_EASYLOGGINGPP
 
 #define BAR_WIDTH 50
 
+// Размер части файла, вырабатываемой за один шаг конвейера,
+// и число частей в обработке (тройная буферизация).
+static constexpr size_t CHUNK_SIZE = 16 * BUFFER_SIZE;
+static constexpr size_t PIPELINE_DEPTH = 3;
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+using RNG = CTR_DRBG<Kuznechik, true>;
+
 struct Params {
     std::string out_file = "";
     size_t num = 0;
+    LockedMemoryPolicy memory_policy = LockedMemoryPolicy::Fail;
 };
 
 static void printHelp(const char* progName) noexcept {
-    std::cout << "Использование: " << progName << " -o <файл> -n <размер>\n"
+    std::cout << "Использование: " << progName << " -o <файл> -n <размер> [-m <политика>]\n"
               << "Параметры:\n"
               << "  -o <файл>     Указать путь к выходному файлу\n"
               << "  -n <размер>   Количество генерируемых байт.\n"
@@ -29,6 +42,10 @@ static void printHelp(const char* progName) noexcept {
               << "                  -n 1024     (1024 байта)\n"
               << "                  -n 10K      (10 килобайт)\n"
               << "                  -n 5.5M     (5.5 мегабайт)\n"
+              << "  -m <политика> Действие при исчерпании лимита заблокированной памяти:\n"
+              << "                  fail     - завершиться с ошибкой (по умолчанию)\n"
+              << "                  wait     - ждать освобождения памяти\n"
+              << "                  unlocked - выделять память секретов без mlock\n"
               << "  -h            Показать эту справку\n"
               << std::endl;
 }
@@ -50,7 +67,7 @@ size_t parseNum(const std::string &str) {
 
 static int getParams(Params &params, int argc, char **argv) noexcept {
     int opt;
-    while ((opt = getopt(argc, argv, "o:n:h")) != -1)
+    while ((opt = getopt(argc, argv, "o:n:m:h")) != -1)
         switch (opt) {
             case 'o': {
                 params.out_file = std::string(optarg);
@@ -68,6 +85,16 @@ static int getParams(Params &params, int argc, char **argv) noexcept {
                 }
                 break;
             }
+            case 'm': {
+                try {
+                    params.memory_policy = parseLockedMemoryPolicy(optarg);
+                } catch (const crispex::invalid_argument &e) {
+                    std::cerr << "Ошибка. Некорректный аргумент (-m): " << e.what() << std::endl;
+                    printHelp(argv[0]);
+                    return -2;
+                }
+                break;
+            }
             case 'h': {
                 printHelp(argv[0]);
                 return -3;
@@ -91,6 +118,48 @@ static int getParams(Params &params, int argc, char **argv) noexcept {
     return 0;
 }
 
+// Выходной файл с записью через O_DIRECT в обход страничного кэша.
+// Если файловая система не поддерживает O_DIRECT, а также для
+// последней неполной части используется обычная запись.
+class OutputFile {
+private:
+    int fd_;
+    bool direct_;
+
+    inline void disableDirect() noexcept {
+        const int flags = fcntl(fd_, F_GETFL);
+        if (flags >= 0) fcntl(fd_, F_SETFL, flags & ~O_DIRECT);
+        direct_ = false;
+    }
+public:
+    explicit OutputFile(const std::string &path) {
+        fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_DIRECT, 0644);
+        direct_ = fd_ >= 0;
+        if (!direct_) fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd_ < 0) throw crispex::privilege_error("Не удалось открыть выходной файл.");
+    }
+    OutputFile(const OutputFile &) = delete;
+    OutputFile &operator=(const OutputFile &) = delete;
+    inline ~OutputFile() { close(fd_); }
+
+    void write(const uint8_t *data, size_t size, size_t written) {
+        if (direct_ && size % DIRECT_IO_ALIGNMENT) disableDirect();
+        while (size) {
+            const ssize_t n = ::write(fd_, data, size);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && errno == EINVAL && direct_) { disableDirect(); continue; }
+            if (n <= 0) throw crispex::privilege_error("Запись прервана после записи " + std::to_string(written) + " байт.");
+            data += n; size -= static_cast<size_t>(n); written += static_cast<size_t>(n);
+        }
+    }
+};
+
+// Каждое обращение к ПДСЧ не превышает MaxBytesPerRequest.
+static void generateChunk(RNG &rng, uint8_t *buffer, const size_t size) {
+    for (size_t offset = 0; offset < size; offset += RNG::MaxBytesPerRequest)
+        rng(buffer + offset, std::min(RNG::MaxBytesPerRequest, size - offset));
+}
+
 void printProgress(size_t current, size_t total) {
     float progress = static_cast<float>(current) / static_cast<float>(total);
     size_t pos = static_cast<size_t>(BAR_WIDTH * progress);
@@ -109,30 +178,62 @@ void printProgress(size_t current, size_t total) {
 
 int main(int argc, char **argv) {
     confLog(false, true, "lab.log");
+    std::atexit(logSecureBufferStats);
     Params params;
     if (getParams(params, argc, argv)) return -1;
+    {
+        // Без CAP_IPC_LOCK лимит блокировки мал; выделение памяти секретов
+        // без mlock допускается только явным -m unlocked.
+        LockedMemoryBudget::Settings settings;
+        settings.policy = params.memory_policy;
+        // Буферы конвейера - одно отображение на больших страницах,
+        // выровненное и для O_DIRECT.
+        settings.huge_page_threshold = LockedMemoryBudget::HugePageSize;
+        LockedMemoryBudget::configure(settings);
+        LockedArena::reserve(4 * LockedArena::ChunkSize);
+        SecureBuffer<32> key; key.zero();
+        ParallelPolicy::calibrate(Kuznechik(key));
+    }
     try {
-        std::ofstream out_file(params.out_file, std::ios::binary);
-        if (!out_file) throw crispex::privilege_error("Не удалось открыть выходной файл.");
-        CTR_DRBG<Kuznechik, true> rng;
-
-        uint8_t buffer[BUFFER_SIZE];
-        size_t num_of_blocks = params.num / BUFFER_SIZE;
-        size_t remainder = params.num % BUFFER_SIZE;
-
-        for (size_t i = 0; i < num_of_blocks; ++i) {
-            rng(buffer, BUFFER_SIZE);
-            out_file.write(reinterpret_cast<char *>(buffer), BUFFER_SIZE);
-            if (!out_file) throw crispex::privilege_error("Запись прервана после записи " + std::to_string(i * BUFFER_SIZE) + " байт.");
-            printProgress((i + 1) * BUFFER_SIZE, params.num);
-        }
-        if (remainder > 0) {
-            rng(buffer, remainder);
-            out_file.write(reinterpret_cast<char *>(buffer), static_cast<std::streamsize>(remainder));
-            if (!out_file)
-                throw crispex::privilege_error("Запись прервана после записи "  + std::to_string(num_of_blocks * BUFFER_SIZE) + " байт.");
-            printProgress(params.num, params.num);
+        OutputFile out_file(params.out_file);
+        RNG rng;
+        SecureVector buffers(PIPELINE_DEPTH * CHUNK_SIZE);
+        const size_t num_of_chunks = (params.num + CHUNK_SIZE - 1) / CHUNK_SIZE;
+#ifndef DONT_USE_TBB
+        // Выработка следующей части идёт параллельно с записью предыдущей.
+        // Не более PIPELINE_DEPTH частей в обработке, и запись идёт по порядку,
+        // поэтому буфер части i освобождается до начала части i + PIPELINE_DEPTH.
+        struct Chunk {
+            const uint8_t *data;
+            size_t offset;
+            size_t size;
+        };
+        size_t next_chunk = 0;
+        tbb::parallel_pipeline(PIPELINE_DEPTH,
+            tbb::make_filter<void, Chunk>(tbb::filter_mode::serial_in_order,
+            [&](tbb::flow_control &fc) -> Chunk {
+                if (next_chunk == num_of_chunks) { fc.stop(); return {}; }
+                const size_t offset = next_chunk * CHUNK_SIZE;
+                const size_t size = std::min(CHUNK_SIZE, params.num - offset);
+                uint8_t *data = buffers.data() + next_chunk++ % PIPELINE_DEPTH * CHUNK_SIZE;
+                generateChunk(rng, data, size);
+                return {data, offset, size};
+            }) &
+            tbb::make_filter<Chunk, void>(tbb::filter_mode::serial_in_order,
+            [&](const Chunk &chunk) {
+                out_file.write(chunk.data, chunk.size, chunk.offset);
+                printProgress(chunk.offset + chunk.size, params.num);
+            })
+        );
+#else
+        for (size_t i = 0; i < num_of_chunks; ++i) {
+            const size_t offset = i * CHUNK_SIZE;
+            const size_t size = std::min(CHUNK_SIZE, params.num - offset);
+            generateChunk(rng, buffers.data(), size);
+            out_file.write(buffers.data(), size, offset);
+            printProgress(offset + size, params.num);
         }
+#endif
         std::cout << std::endl;
         std::cout << "Генерация завершена успешно." << std::endl;
     } catch (const std::exception &e) {
@@ -1,6 +1,7 @@
 #include <ncurses.h>
 #include <future>
 #include "CRISPMessenger.hpp"
+#include "Kuznechik.hpp"
 #include "utf8.h"
 
 INITIALIZE_EASYLOGGINGPP
@@ -14,6 +15,7 @@ struct Params {
     uint16_t local_port = 0;
     std::string remote_ip = "";
     uint16_t remote_port = 0;
+    LockedMemoryPolicy memory_policy = LockedMemoryPolicy::Fail;
 };
 
 
@@ -29,6 +31,8 @@ static void printHelp(const std::string& execName) {
               << "  -l                Показать список доступных криптографических наборов и выйти\n"
               << "  -p <порт>         Локальный порт для запуска серверного сокета\n"
               << "  -a <ip:порт>      Адрес получателя в формате ip:порт\n"
+              << "  -m <политика>     Действие при исчерпании лимита заблокированной памяти:\n"
+              << "                    fail (по умолчанию), wait или unlocked (без mlock)\n"
               << "\n"
               << "Пример:\n"
               << "  " << execName << " -k master.key -c KuznechikCTR_KuznechikCMAC_256_128_R13235651022_HMAC_HMAC256 -u Alice -r Bob\n"
@@ -45,7 +49,7 @@ static void printAvailableSuites() {
 
 static void getParams(Params &params, int argc, char **argv) {
     int opt;
-    while ((opt = getopt(argc, argv, "k:c:d:u:r:hlp:a:")) != -1) {
+    while ((opt = getopt(argc, argv, "k:c:d:u:r:hlp:a:m:")) != -1) {
         switch (opt) {
             case 'k': {
                 params.key_file = std::string(optarg);
@@ -91,6 +95,10 @@ static void getParams(Params &params, int argc, char **argv) {
                 params.remote_port = static_cast<uint16_t>(std::strtoul(addr.substr(colon_idx + 1).c_str(), NULL, 10));
                 break;
             }
+            case 'm': {
+                params.memory_policy = parseLockedMemoryPolicy(optarg);
+                break;
+            }
             default: {
                 std::cerr << "Несуществующий аргумент " << static_cast<char>(opt) << " ." << std::endl;
                 printHelp(argv[0]);
@@ -340,6 +348,7 @@ int main(int argc, char **argv) {
     setlocale(LC_ALL, "");
     std::signal(SIGINT, handle_sigint);
     confLog(false, true, "lab.log");
+    std::atexit(logSecureBufferStats);
     Params params;
     LOG(INFO) << "Считывание параметров командной строки";
     try { getParams(params, argc, argv); }
@@ -348,6 +357,16 @@ int main(int argc, char **argv) {
         return -1;
     }
     LOG(INFO) << "Параметры успешно считаны";
+    {
+        // Без CAP_IPC_LOCK лимит блокировки мал; выделение памяти секретов
+        // без mlock допускается только явным -m unlocked.
+        LockedMemoryBudget::Settings settings;
+        settings.policy = params.memory_policy;
+        LockedMemoryBudget::configure(settings);
+        LockedArena::reserve(4 * LockedArena::ChunkSize);
+        SecureBuffer<32> key; key.zero();
+        ParallelPolicy::calibrate(Kuznechik(key));
+    }
     try {
         messenger = std::make_shared<CRISPMessenger>(
             params.local_port, params.remote_ip, params.remote_port,
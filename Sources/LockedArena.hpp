@@ -0,0 +1,224 @@
+/*  Общая на процесс арена заблокированной памяти для SecureBuffer.
+    Память запрашивается у ядра участками по ChunkSize байт, которые
+    блокируются (mlock) и исключаются из дампов (MADV_DONTDUMP) один
+    раз. Участки делятся на страницы-слэбы классов 16, 32, ..., 4096 байт.
+    Каждый поток держит кэш свободных ячеек, поэтому выделение и
+    освобождение на горячем пути - это операции со стеком указателей
+    без системных вызовов и блокировок. Память ячеек в ОС не
+    возвращается. Буферы больше MaxClass выделяются отдельным mmap.
+    Все отображения учитываются LockedMemoryBudget; reserve() заранее
+    блокирует участки, пока это позволяет бюджет.
+    Ячейка выровнена на размер своего класса, поэтому буферы от 64 байт
+    начинаются с границы строки кэша и не делят её с соседями.
+    Участки и списки свободных ячеек ведутся по узлам NUMA: кэш потока
+    пополняется с узла, на котором поток был создан, новые участки
+    привязываются к этому узлу (mbind) до блокировки, а освобождённые
+    ячейки возвращаются на узел своего участка.
+*/
+#ifndef LOCKED_ARENA_HPP
+#define LOCKED_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <new>
+#include "LockedMemoryBudget.hpp"
+
+class LockedArena {
+public:
+    static constexpr size_t MinClass = 16;
+    static constexpr size_t MaxClass = 4096;
+    static constexpr size_t PageSize = 4096;
+    static constexpr size_t ChunkSize = 64 * 1024;
+    static constexpr size_t CacheLine = 64;
+
+    // Гарантированное выравнивание буфера размера size.
+    static constexpr size_t alignment(const size_t size) noexcept
+        { return size > MaxClass ? PageSize : classSize(classIndex(size)); }
+
+    static inline void *allocate(const size_t size);
+    static inline void deallocate(void *ptr, const size_t size) noexcept;
+    // Возвращает объём, фактически заблокированный про запас.
+    static inline size_t reserve(const size_t size) noexcept;
+private:
+    static constexpr size_t NumClasses = 9;
+    static constexpr size_t CacheSize = 64;
+    static constexpr unsigned MaxNodes = LockedMemoryBudget::MaxNodes;
+    // SecureBufferStats ведёт счётчики по тем же классам плюс один.
+    static_assert(SecureBufferStats::MinClass == MinClass && SecureBufferStats::NumClasses == NumClasses + 1);
+
+    static constexpr size_t classIndex(const size_t size) noexcept {
+        size_t index = 0;
+        for (size_t class_size = MinClass; class_size < size; class_size <<= 1) ++index;
+        return index;
+    }
+    static constexpr size_t classSize(const size_t index) noexcept { return MinClass << index; }
+
+    struct FreeNode { FreeNode *next; };
+
+    struct Node {
+        FreeNode *free[NumClasses] = {};
+        uint8_t *chunk_pos = nullptr;
+        uint8_t *chunk_end = nullptr;
+        FreeNode *reserved = nullptr;
+    };
+    struct Global {
+        std::mutex mutex;
+        Node nodes[MaxNodes];
+        // Начало участка -> узел NUMA.
+        std::map<const uint8_t *, unsigned> chunks;
+    };
+    // Никогда не разрушается: буферы статических объектов
+    // освобождаются после завершения main.
+    static inline Global &global() {
+        static Global *const instance = new Global();
+        return *instance;
+    }
+
+    struct Cache {
+        void *slots[NumClasses][CacheSize];
+        size_t count[NumClasses] = {};
+        unsigned node = LockedMemoryBudget::currentNode();
+        inline ~Cache();
+    };
+    // Флаг тривиально разрушаемый, поэтому остаётся доступным после
+    // разрушения кэша при завершении потока.
+    static inline thread_local bool cache_destroyed_ = false;
+    static inline Cache &cache() {
+        static thread_local Cache instance;
+        return instance;
+    }
+
+    static inline void refill(Cache &cache, const size_t index);
+    static inline void flush(Cache &cache, const size_t index, const size_t keep) noexcept;
+    static inline void *allocateCell(const size_t index);
+    static inline void deallocateCell(void *ptr, const size_t index) noexcept;
+    static inline unsigned nodeOf(const void *ptr) noexcept;
+    static inline void addChunk(void *chunk, const unsigned node);
+    static inline void *allocateGlobal(const unsigned node, const size_t index);
+    static inline void deallocateGlobal(const unsigned node, void *ptr, const size_t index) noexcept;
+};
+
+// Функции ниже вызываются под мьютексом global().
+inline unsigned LockedArena::nodeOf(const void *ptr) noexcept {
+    const Global &g = global();
+    auto it = g.chunks.upper_bound(static_cast<const uint8_t *>(ptr));
+    return (--it)->second;
+}
+
+inline void LockedArena::addChunk(void *chunk, const unsigned node) {
+    global().chunks.emplace(static_cast<const uint8_t *>(chunk), node);
+}
+
+inline void *LockedArena::allocateGlobal(const unsigned node, const size_t index) {
+    Node &n = global().nodes[node];
+    if (FreeNode *cell = n.free[index]) {
+        n.free[index] = cell->next;
+        return cell;
+    }
+    if (n.chunk_pos == n.chunk_end) {
+        if (FreeNode *chunk = n.reserved) {
+            n.reserved = chunk->next;
+            n.chunk_pos = reinterpret_cast<uint8_t *>(chunk);
+        }
+        else {
+            // Под мьютексом арены не ждём: участки не освобождаются.
+            void *mapped = LockedMemoryBudget::map(ChunkSize, node, false);
+            try { addChunk(mapped, node); }
+            catch (...) { LockedMemoryBudget::unmap(mapped, ChunkSize); throw; }
+            n.chunk_pos = static_cast<uint8_t *>(mapped);
+        }
+        n.chunk_end = n.chunk_pos + ChunkSize;
+    }
+    // Новый слэб: первая ячейка возвращается, остальные - в список свободных.
+    uint8_t *slab = n.chunk_pos;
+    n.chunk_pos += PageSize;
+    const size_t size = classSize(index);
+    for (size_t offset = PageSize - size; offset > 0; offset -= size)
+        deallocateGlobal(node, slab + offset, index);
+    return slab;
+}
+
+inline void LockedArena::deallocateGlobal(const unsigned node, void *ptr, const size_t index) noexcept {
+    Node &n = global().nodes[node];
+    FreeNode *cell = static_cast<FreeNode *>(ptr);
+    cell->next = n.free[index];
+    n.free[index] = cell;
+}
+
+inline void LockedArena::refill(Cache &cache, const size_t index) {
+    std::lock_guard lock(global().mutex);
+    while (cache.count[index] < CacheSize / 2)
+        cache.slots[index][cache.count[index]++] = allocateGlobal(cache.node, index);
+}
+
+inline void LockedArena::flush(Cache &cache, const size_t index, const size_t keep) noexcept {
+    std::lock_guard lock(global().mutex);
+    while (cache.count[index] > keep) {
+        void *cell = cache.slots[index][--cache.count[index]];
+        deallocateGlobal(nodeOf(cell), cell, index);
+    }
+}
+
+inline LockedArena::Cache::~Cache() {
+    cache_destroyed_ = true;
+    for (size_t index = 0; index < NumClasses; ++index)
+        flush(*this, index, 0);
+}
+
+inline void *LockedArena::allocateCell(const size_t index) {
+    if (cache_destroyed_) {
+        std::lock_guard lock(global().mutex);
+        return allocateGlobal(LockedMemoryBudget::currentNode(), index);
+    }
+    Cache &c = cache();
+    if (!c.count[index]) refill(c, index);
+    return c.slots[index][--c.count[index]];
+}
+
+inline void LockedArena::deallocateCell(void *ptr, const size_t index) noexcept {
+    if (cache_destroyed_) {
+        std::lock_guard lock(global().mutex);
+        deallocateGlobal(nodeOf(ptr), ptr, index);
+        return;
+    }
+    Cache &c = cache();
+    if (c.count[index] == CacheSize) flush(c, index, CacheSize / 2);
+    c.slots[index][c.count[index]++] = ptr;
+}
+
+inline void *LockedArena::allocate(const size_t size) {
+    void *ptr = size > MaxClass
+        ? LockedMemoryBudget::map(size, LockedMemoryBudget::currentNode())
+        : allocateCell(classIndex(size));
+    SecureBufferStats::allocated(size);
+    return ptr;
+}
+
+inline void LockedArena::deallocate(void *ptr, const size_t size) noexcept {
+    SecureBufferStats::deallocated(size);
+    if (size > MaxClass) LockedMemoryBudget::unmap(ptr, size);
+    else deallocateCell(ptr, classIndex(size));
+}
+
+inline size_t LockedArena::reserve(const size_t size) noexcept {
+    const unsigned node = LockedMemoryBudget::currentNode();
+    size_t reserved = 0;
+    for (; reserved < size; reserved += ChunkSize) {
+        void *chunk = LockedMemoryBudget::tryMapLocked(ChunkSize, node);
+        if (!chunk) break;
+        std::lock_guard lock(global().mutex);
+        try { addChunk(chunk, node); }
+        catch (const std::bad_alloc &) {
+            LockedMemoryBudget::unmap(chunk, ChunkSize);
+            break;
+        }
+        FreeNode *cell = static_cast<FreeNode *>(chunk);
+        cell->next = global().nodes[node].reserved;
+        global().nodes[node].reserved = cell;
+    }
+    return reserved;
+}
+
+#endif
@@ -0,0 +1,329 @@
+/*  Учёт заблокированной памяти процесса. Все mmap + mlock для
+    SecureBuffer проходят через LockedMemoryBudget::map(), который
+    сверяет объём с RLIMIT_MEMLOCK (считывается при первом обращении)
+    и ведёт счётчики: заблокировано сейчас, максимум за время работы,
+    отдано без блокировки. При исчерпании бюджета или отказе mlock
+    действует политика:
+      Fail     - std::bad_alloc (поведение по умолчанию);
+      Wait     - ожидание освобождения памяти не дольше wait_timeout,
+                 затем std::bad_alloc. Память освобождается только
+                 unmap() отдельных отображений (буферы больше
+                 LockedArena::MaxClass); участки арены не возвращаются,
+                 поэтому для них Wait действует как Fail, без ожидания;
+      Unlocked - память выдаётся без mlock, только с MADV_DONTDUMP.
+    При huge_page_threshold > 0 отображения не меньше порога
+    выделяются страницами по 2 МиБ: сначала MAP_HUGETLB | MAP_LOCKED |
+    MAP_POPULATE, при отсутствии зарезервированных страниц - выровненное
+    отображение с MADV_HUGEPAGE (прозрачные большие страницы), которое
+    блокируется и заполняется одним вызовом mlock.
+    Отображение с указанным узлом NUMA привязывается к нему (mbind с
+    MPOL_PREFERRED) до блокировки, поэтому страницы размещаются на этом
+    узле. Ядро без NUMA возвращает ошибку, и она игнорируется.
+*/
+#ifndef LOCKED_MEMORY_BUDGET_HPP
+#define LOCKED_MEMORY_BUDGET_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <unordered_set>
+#include <climits>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <easylogging++.h>
+#include "SecureBufferStats.hpp"
+
+enum class LockedMemoryPolicy { Fail, Wait, Unlocked };
+
+struct LockedMemorySettings {
+    LockedMemoryPolicy policy = LockedMemoryPolicy::Fail;
+    std::chrono::milliseconds wait_timeout{1000};
+    // Предел заблокированной памяти в байтах, не выше RLIMIT_MEMLOCK;
+    // 0 - весь лимит.
+    size_t limit = 0;
+    // Минимальный размер отображения на больших страницах; 0 - выключено.
+    size_t huge_page_threshold = 0;
+};
+
+class LockedMemoryBudget {
+public:
+    using Policy = LockedMemoryPolicy;
+    using Settings = LockedMemorySettings;
+    static constexpr size_t HugePageSize = 2 * 1024 * 1024;
+    // Узлы с номерами от MaxNodes не различаются и считаются нулевым.
+    static constexpr unsigned MaxNodes = 64;
+    static constexpr unsigned AnyNode = MaxNodes;
+
+    struct Stats {
+        size_t limit;
+        size_t locked;
+        size_t high_water;
+        size_t unlocked;
+        size_t fallbacks;
+        size_t huge;
+    };
+
+    static inline void configure(const Settings &settings);
+    static inline Stats stats() noexcept;
+    static inline size_t available() noexcept;
+
+    // Отображение size байт, заблокированных согласно политике.
+    // При may_wait == false политика Wait не ждёт и действует как Fail.
+    static inline void *map(const size_t size, const unsigned node = AnyNode, const bool may_wait = true);
+    // Отображение только в пределах бюджета, без применения политики.
+    static inline void *tryMapLocked(const size_t size, const unsigned node = AnyNode) noexcept;
+    static inline void unmap(void *ptr, const size_t size) noexcept;
+
+    // Узел NUMA процессора, на котором сейчас выполняется поток.
+    static inline unsigned currentNode() noexcept {
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) || node >= MaxNodes) return 0;
+        return node;
+    }
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable released;
+        Settings settings;
+        size_t system_limit;
+        size_t limit;
+        size_t locked = 0;
+        size_t high_water = 0;
+        size_t unlocked = 0;
+        size_t fallbacks = 0;
+        size_t huge = 0;
+        std::unordered_set<const void *> unlocked_mappings;
+        std::unordered_set<const void *> huge_mappings;
+    };
+    // Никогда не разрушается, как и состояние LockedArena.
+    static inline State &state() {
+        static State *const instance = [] {
+            State *s = new State();
+            rlimit limit;
+            s->system_limit = getrlimit(RLIMIT_MEMLOCK, &limit) || limit.rlim_cur == RLIM_INFINITY
+                ? std::numeric_limits<size_t>::max()
+                : static_cast<size_t>(limit.rlim_cur);
+            s->limit = s->system_limit;
+            return s;
+        }();
+        return *instance;
+    }
+
+    static inline size_t pages(const size_t size) noexcept {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return (size + page - 1) / page * page;
+    }
+    static inline size_t hugePages(const size_t size) noexcept
+        { return (size + HugePageSize - 1) / HugePageSize * HugePageSize; }
+    static inline void *mapDontDump(const size_t size) {
+        void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) throw std::bad_alloc();
+        madvise(ptr, size, MADV_DONTDUMP);
+        return ptr;
+    }
+    // Отображение length байт (кратно HugePageSize), выровненное на
+    // границу большой страницы, чтобы ядро могло использовать THP.
+    static inline void *mapTransparentHuge(const size_t length) {
+        const size_t padded = length + HugePageSize;
+        uint8_t *raw = static_cast<uint8_t *>(mapDontDump(padded));
+        const uintptr_t address = reinterpret_cast<uintptr_t>(raw);
+        uint8_t *aligned = raw + (HugePageSize - address % HugePageSize) % HugePageSize;
+        if (aligned != raw) munmap(raw, static_cast<size_t>(aligned - raw));
+        if (aligned + length != raw + padded)
+            munmap(aligned + length, static_cast<size_t>(raw + padded - (aligned + length)));
+        madvise(aligned, length, MADV_HUGEPAGE);
+        return aligned;
+    }
+    static inline void bindToNode(void *ptr, const size_t size, const unsigned node) noexcept {
+        if (node >= MaxNodes) return;
+        static constexpr int PreferredPolicy = 1;  // MPOL_PREFERRED из <numaif.h>
+        const unsigned long mask = 1UL << node;
+        [[maybe_unused]] const long result =
+            syscall(SYS_mbind, ptr, size, PreferredPolicy, &mask, sizeof(mask) * CHAR_BIT + 1, 0);
+    }
+    static inline void *mapHuge(const size_t size, const unsigned node, const bool may_wait);
+    // Вызывается под мьютексом, на время mlock мьютекс отпускается.
+    static inline bool lock(std::unique_lock<std::mutex> &guard, void *ptr, const size_t size) noexcept;
+};
+
+inline void LockedMemoryBudget::configure(const Settings &settings) {
+    State &s = state();
+    size_t limit;
+    {
+        std::lock_guard guard(s.mutex);
+        s.settings = settings;
+        s.limit = settings.limit ? std::min(settings.limit, s.system_limit) : s.system_limit;
+        limit = s.limit;
+    }
+    s.released.notify_all();
+    LOG(INFO) << "Заблокированная память: лимит " << limit << " байт, политика "
+              << static_cast<int>(settings.policy);
+}
+
+inline LockedMemoryBudget::Stats LockedMemoryBudget::stats() noexcept {
+    State &s = state();
+    std::lock_guard guard(s.mutex);
+    return {s.limit, s.locked, s.high_water, s.unlocked, s.fallbacks, s.huge};
+}
+
+inline size_t LockedMemoryBudget::available() noexcept {
+    State &s = state();
+    std::lock_guard guard(s.mutex);
+    return s.limit > s.locked ? s.limit - s.locked : 0;
+}
+
+inline bool LockedMemoryBudget::lock(std::unique_lock<std::mutex> &guard, void *ptr, const size_t size) noexcept {
+    State &s = state();
+    const size_t bytes = pages(size);
+    if (s.limit < s.locked || s.limit - s.locked < bytes) return false;
+    s.locked += bytes;
+    guard.unlock();
+    const bool locked = !mlock(ptr, size);
+    SecureBufferStats::locked(locked ? size : 0);
+    guard.lock();
+    if (!locked) {
+        // Бюджет есть, но ядро отказало: лимит занят блокировками вне арены.
+        s.locked -= bytes;
+        return false;
+    }
+    s.high_water = std::max(s.high_water, s.locked);
+    return true;
+}
+
+inline void *LockedMemoryBudget::map(const size_t size, const unsigned node, const bool may_wait) {
+    State &s = state();
+    size_t threshold;
+    {
+        std::lock_guard guard(s.mutex);
+        threshold = s.settings.huge_page_threshold;
+    }
+    if (threshold && size >= threshold) return mapHuge(size, node, may_wait);
+    void *ptr = mapDontDump(size);
+    bindToNode(ptr, size, node);
+    std::unique_lock guard(s.mutex);
+    const auto deadline = std::chrono::steady_clock::now() + s.settings.wait_timeout;
+    while (!lock(guard, ptr, size)) {
+        switch (s.settings.policy) {
+            case Policy::Wait:
+                if (may_wait && s.released.wait_until(guard, deadline) != std::cv_status::timeout) continue;
+                [[fallthrough]];
+            case Policy::Fail:
+                guard.unlock();
+                munmap(ptr, size);
+                throw std::bad_alloc();
+            case Policy::Unlocked:
+                s.unlocked += pages(size);
+                s.unlocked_mappings.insert(ptr);
+                if (s.fallbacks++ == 0) {
+                    guard.unlock();
+                    LOG(WARNING) << "Исчерпан лимит заблокированной памяти (" << s.limit
+                                 << " байт), память секретов выделяется без mlock";
+                }
+                return ptr;
+        }
+    }
+    return ptr;
+}
+
+inline void *LockedMemoryBudget::mapHuge(const size_t size, const unsigned node, const bool may_wait) {
+    State &s = state();
+    const size_t length = hugePages(size);
+    std::unique_lock guard(s.mutex);
+    // Страницы hugetlb не вытесняются и блокируются при отображении,
+    // поэтому бюджет проверяется заранее.
+    if (s.limit >= s.locked && s.limit - s.locked >= length) {
+        s.locked += length;
+        guard.unlock();
+        void *ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_LOCKED | MAP_POPULATE, -1, 0);
+        if (ptr != MAP_FAILED) SecureBufferStats::locked(length);
+        guard.lock();
+        if (ptr != MAP_FAILED) {
+            madvise(ptr, length, MADV_DONTDUMP);
+            s.high_water = std::max(s.high_water, s.locked);
+            s.huge += length;
+            s.huge_mappings.insert(ptr);
+            return ptr;
+        }
+        s.locked -= length;
+    }
+    guard.unlock();
+    void *ptr = mapTransparentHuge(length);
+    bindToNode(ptr, length, node);
+    guard.lock();
+    const auto deadline = std::chrono::steady_clock::now() + s.settings.wait_timeout;
+    while (!lock(guard, ptr, length)) {
+        switch (s.settings.policy) {
+            case Policy::Wait:
+                if (may_wait && s.released.wait_until(guard, deadline) != std::cv_status::timeout) continue;
+                [[fallthrough]];
+            case Policy::Fail:
+                guard.unlock();
+                munmap(ptr, length);
+                throw std::bad_alloc();
+            case Policy::Unlocked:
+                s.unlocked += length;
+                s.unlocked_mappings.insert(ptr);
+                s.huge += length;
+                s.huge_mappings.insert(ptr);
+                if (s.fallbacks++ == 0) {
+                    guard.unlock();
+                    LOG(WARNING) << "Исчерпан лимит заблокированной памяти (" << s.limit
+                                 << " байт), память секретов выделяется без mlock";
+                }
+                return ptr;
+        }
+    }
+    s.huge += length;
+    s.huge_mappings.insert(ptr);
+    return ptr;
+}
+
+inline void *LockedMemoryBudget::tryMapLocked(const size_t size, const unsigned node) noexcept {
+    State &s = state();
+    void *ptr;
+    try { ptr = mapDontDump(size); }
+    catch (const std::bad_alloc &) { return nullptr; }
+    bindToNode(ptr, size, node);
+    std::unique_lock guard(s.mutex);
+    if (lock(guard, ptr, size)) return ptr;
+    guard.unlock();
+    munmap(ptr, size);
+    return nullptr;
+}
+
+inline void LockedMemoryBudget::unmap(void *ptr, const size_t size) noexcept {
+    State &s = state();
+    bool locked;
+    size_t length = size;
+    {
+        std::lock_guard guard(s.mutex);
+        if (s.huge_mappings.erase(ptr)) {
+            length = hugePages(size);
+            s.huge -= length;
+        }
+        locked = !s.unlocked_mappings.erase(ptr);
+        if (!locked) s.unlocked -= pages(length);
+    }
+    if (locked) {
+        munlock(ptr, length);
+        SecureBufferStats::unlocked();
+    }
+    munmap(ptr, length);
+    if (locked) {
+        {
+            std::lock_guard guard(s.mutex);
+            s.locked -= pages(length);
+        }
+        s.released.notify_all();
+    }
+}
+
+#endif
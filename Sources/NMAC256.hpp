@@ -22,6 +22,8 @@ public:
     std::vector<uint8_t> digest() noexcept override;
     void digest(uint8_t *digest_buffer) noexcept override;
     void clear() noexcept override;
+    // Стирание ключа и состояния; до initKeySchedule контекст непригоден.
+    inline void wipe() noexcept { inner_hasher_.clear(); secureWipe(padded_key_.raw(), 64); }
 
     static constexpr size_t BlockSize = 64;
     static constexpr size_t DigestSize = 32;
@@ -30,6 +32,7 @@ public:
 
 template <size_t KeyLen>
 void NMAC256<KeyLen>::initKeySchedule(const SecureBuffer<KeyLen> &key) noexcept {
+    inner_hasher_.clear();
     padded_key_.zero();
     if constexpr (KeyLen > 64) {
         inner_hasher_.update(key.raw(), KeyLen);
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "Cipher.hpp"
+#include "Block128.hpp"
 #include "Hash.hpp"
 #include "CRISPExceptions.hpp"
 
@@ -37,6 +38,14 @@ public:
         buffered_len_ = 0; accumulator_.zero(); digest_key_.zero();
         ctx_.encrypt(digest_key_); transformAdditionalKey(digest_key_);
     }
+    // Стирание ключа и состояния; до initKeySchedule контекст непригоден.
+    inline void wipe() noexcept {
+        ctx_.wipe();
+        secureWipe(digest_key_.raw(), CipherType::BlockSize);
+        secureWipe(accumulator_.raw(), CipherType::BlockSize);
+        secureWipe(buf_.raw(), CipherType::BlockSize);
+        buffered_len_ = 0;
+    }
 
     static constexpr size_t BlockSize = CipherType::BlockSize;
     static constexpr size_t DigestSize = CipherType::BlockSize;
@@ -70,6 +79,7 @@ void OMAC<CipherType>::initKeySchedule(const SecureBuffer<CipherType::KeySize> &
     );
     digest_key_.zero(); ctx_.encrypt(digest_key_); transformAdditionalKey(digest_key_);
     accumulator_.zero();
+    buffered_len_ = 0;
 }
 
 template <IsCipher CipherType>
@@ -77,7 +87,20 @@ void OMAC<CipherType>::update(const uint8_t *data, const size_t size) noexcept {
     size_t current_index = 0;
     while (size - current_index > 0) {
         if (buffered_len_ == CipherType::BlockSize) {
-            ctx_.encrypt(accumulator_ += buf_);
+            if constexpr (HasBlock128<CipherType>) {
+                // Полные блоки, кроме последнего, идут из data прямо в
+                // аккумулятор в регистрах; последний остаётся в buf_ для finalize.
+                Block128 accumulator = Block128::load(accumulator_.raw());
+                accumulator.xorFrom(buf_.raw());
+                ctx_.encryptBlock(accumulator);
+                for (; size - current_index > CipherType::BlockSize; current_index += CipherType::BlockSize) {
+                    accumulator.xorFrom(data + current_index);
+                    ctx_.encryptBlock(accumulator);
+                }
+                accumulator.store(accumulator_.raw());
+                accumulator.wipe();
+            }
+            else ctx_.encrypt(accumulator_ += buf_);
             buffered_len_ = 0;
         }
         size_t to_copy = std::min(CipherType::BlockSize - buffered_len_, size - current_index);
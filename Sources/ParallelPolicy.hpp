@@ -0,0 +1,128 @@
+/*  Политика параллельного выполнения поблочных операций (CTR, CTR_DRBG).
+    Короткие запросы выполняются в вызывающем потоке, длинные разбиваются
+    на задачи TBB размером grain блоков. max_concurrency ограничивает
+    число потоков через tbb::task_arena (0 - все ядра).
+    Настраивается через configure() или calibrate() до начала работы.
+*/
+#ifndef PARALLEL_POLICY_HPP
+#define PARALLEL_POLICY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+#ifndef DONT_USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include "Cipher.hpp"
+
+struct ParallelSettings {
+    size_t serial_threshold = 256;
+    size_t grain = 128;
+    int max_concurrency = 0;
+};
+
+class ParallelPolicy {
+public:
+    using Settings = ParallelSettings;
+private:
+    static inline std::atomic<size_t> serial_threshold_ = Settings{}.serial_threshold;
+    static inline std::atomic<size_t> grain_ = Settings{}.grain;
+    static inline std::atomic<int> max_concurrency_ = Settings{}.max_concurrency;
+#ifndef DONT_USE_TBB
+    static inline std::mutex arena_mutex_;
+    static inline std::shared_ptr<tbb::task_arena> arena_;
+
+    static inline std::shared_ptr<tbb::task_arena> arena() {
+        std::lock_guard lock(arena_mutex_);
+        return arena_;
+    }
+#endif
+public:
+    static inline Settings settings() noexcept
+        { return {serial_threshold_, grain_, max_concurrency_}; }
+
+    static inline void configure(const Settings &settings) {
+        serial_threshold_ = settings.serial_threshold;
+        grain_ = std::max<size_t>(1, settings.grain);
+        max_concurrency_ = settings.max_concurrency;
+#ifndef DONT_USE_TBB
+        std::lock_guard lock(arena_mutex_);
+        arena_ = settings.max_concurrency > 0
+            ? std::make_shared<tbb::task_arena>(settings.max_concurrency)
+            : nullptr;
+#endif
+        LOG(INFO) << "Параллельное выполнение: порог " << settings.serial_threshold
+                  << " блоков, зерно " << settings.grain
+                  << " блоков, потоков " << settings.max_concurrency;
+    }
+
+    // body(begin, end) обрабатывает блоки с номерами [begin, end).
+    template <typename Body>
+    static void forBlocks(const size_t num_of_blocks, Body &&body) {
+#ifndef DONT_USE_TBB
+        if (num_of_blocks < serial_threshold_) {
+            body(size_t(0), num_of_blocks);
+            return;
+        }
+        const size_t grain = grain_;
+        auto run = [&] {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, num_of_blocks, grain),
+            [&](const tbb::blocked_range<size_t>& r) { body(r.begin(), r.end()); });
+        };
+        if (const auto limited = arena()) limited->execute(run);
+        else run();
+#else
+        body(size_t(0), num_of_blocks);
+#endif
+    }
+
+    // Подбор порога по соотношению стоимости шифрования блока
+    // и накладных расходов на запуск параллельного цикла.
+    template <size_t BlockSize, size_t KeySize>
+    static void calibrate(const Cipher<BlockSize, KeySize> &cipher, const int max_concurrency = 0) {
+        using Clock = std::chrono::steady_clock;
+        static constexpr size_t probe_blocks = 1024;
+        SecureBuffer<BlockSize> block; block.zero();
+        auto start = Clock::now();
+        for (size_t i = 0; i < probe_blocks; ++i) cipher.encrypt(block);
+        const double block_ns = std::max(1.0,
+            std::chrono::duration<double, std::nano>(Clock::now() - start).count() / probe_blocks);
+
+        Settings result;
+        result.max_concurrency = max_concurrency;
+#ifndef DONT_USE_TBB
+        static constexpr size_t probe_loops = 64;
+        // Замер в арене с тем же ограничением потоков, что и при работе.
+        tbb::task_arena arena(max_concurrency > 0 ? max_concurrency : tbb::task_arena::automatic);
+        arena.initialize();
+        const size_t threads = static_cast<size_t>(std::max(1, arena.max_concurrency()));
+        std::atomic<size_t> sink = 0;
+        auto loop = [&] {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, threads, 1),
+            [&](const tbb::blocked_range<size_t>& r) { sink += r.size(); });
+        };
+        double loop_ns = 0;
+        arena.execute([&] {
+            // Первый цикл запускает рабочие потоки TBB и в замер не входит.
+            loop();
+            const auto loops_start = Clock::now();
+            for (size_t i = 0; i < probe_loops; ++i) loop();
+            loop_ns = std::chrono::duration<double, std::nano>(Clock::now() - loops_start).count() / probe_loops;
+        });
+        // Параллелить имеет смысл, когда работа хотя бы вдвое дороже запуска,
+        // а каждая задача - хотя бы в восемь раз дороже своей доли запуска.
+        const size_t overhead_blocks = static_cast<size_t>(loop_ns / block_ns) + 1;
+        result.serial_threshold = std::clamp<size_t>(2 * overhead_blocks, 16, static_cast<size_t>(1) << 16);
+        result.grain = std::clamp<size_t>(8 * overhead_blocks / threads, 16, 1024);
+#endif
+        LOG(INFO) << "Калибровка: шифрование блока " << block_ns << " нс";
+        configure(result);
+    }
+};
+
+#endif
@@ -4,72 +4,120 @@
 #include <cinttypes>
 #include <string.h>
 #include <sys/mman.h>
+#include <endian.h>
 #include <algorithm>
+#include <bit>
 #include <functional>
-#include <random>
+#include <utility>
 #include <easylogging++.h>
+#include "LockedArena.hpp"
+#include "SecureWipe.hpp"
+
+// Сложение по модулю 2 машинными словами. Цикл без зависимостей
+// между итерациями, поэтому компилятор векторизует его.
+// __builtin_memcpy фиксированного размера здесь и в add(), operator<<=,
+// Block128, CTRCounters и secureWipe - намеренное исключение из
+// -fno-builtin-memcpy: это лишь невыровненная загрузка или запись слова
+// без нарушения strict aliasing, и она компилируется в одну инструкцию.
+// Обычный memcpy при этом флаге стал бы вызовом функции на каждое слово.
+// Сохранность затирающих записей secureWipe обеспечивает барьер, а не флаг.
+// dst = src ^ key за один проход; dst может совпадать с src.
+inline void xorBytes(uint8_t *dst, const uint8_t *src, const uint8_t *key, const size_t size) noexcept {
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t a, b;
+        __builtin_memcpy(&a, src + i, sizeof(uint64_t));
+        __builtin_memcpy(&b, key + i, sizeof(uint64_t));
+        a ^= b;
+        __builtin_memcpy(dst + i, &a, sizeof(uint64_t));
+    }
+    for (; i < size; ++i) dst[i] = src[i] ^ key[i];
+}
+
+inline void xorBytes(uint8_t *dst, const uint8_t *src, const size_t size) noexcept
+    { xorBytes(dst, dst, src, size); }
 
 template <size_t N>
 class SecureBuffer {
 private:
-    uint8_t data_[N];
+    // Память выделяется из заблокированной арены, а не внутри объекта.
+    // Перемещение забирает указатель; источник получает новую обнулённую
+    // ячейку при первом обращении, поэтому остаётся пригодным.
+    mutable uint8_t *data_;
+
+    void allocateMovedFrom() const;
+    inline uint8_t *storage() const noexcept {
+        if (!data_) [[unlikely]] allocateMovedFrom();
+        return data_;
+    }
 public:
-    inline SecureBuffer() { if (mlock(data_, N)) throw std::bad_alloc(); }
+    inline SecureBuffer() : data_(static_cast<uint8_t *>(LockedArena::allocate(N))) {}
     inline SecureBuffer(std::initializer_list<uint8_t> init) : SecureBuffer()
         { std::copy(init.begin(), init.end(), data_); }
     inline SecureBuffer(const SecureBuffer &original) : SecureBuffer()
-        { memcpy(data_, original.data_, N); }
-    inline SecureBuffer(SecureBuffer &&original) : SecureBuffer()
-        { memcpy(data_, original.data_, N); }
+        { memcpy(data_, original.storage(), N); }
+    inline SecureBuffer(SecureBuffer &&original) noexcept : data_(original.data_)
+        { original.data_ = nullptr; }
     inline SecureBuffer(const uint8_t (&data)[N]) : SecureBuffer()
         { memcpy(data_, data, N); }
     inline SecureBuffer(uint8_t (&&data)[N]) : SecureBuffer()
         { memcpy(data_, data, N); }
-    inline SecureBuffer& operator=(const SecureBuffer &original) noexcept
-        { if (this != &original) memcpy(data_, original.data_, N); return *this; }
+    inline SecureBuffer& operator=(const SecureBuffer &original)
+        { if (this != &original) memcpy(storage(), original.storage(), N); return *this; }
+    // Старое содержимое уходит источнику и будет затёрто его деструктором.
     inline SecureBuffer& operator=(SecureBuffer &&original) noexcept
-        { if (this != &original) memcpy(data_, original.data_, N);  return *this; }
-    inline SecureBuffer& operator=(const uint8_t (&data)[N]) noexcept
-        { memcpy(data_, data, N); return *this; }
-    inline SecureBuffer& operator=(uint8_t (&&data)[N]) noexcept
-        { memcpy(data_, data, N); return *this; }
+        { std::swap(data_, original.data_); return *this; }
+    inline SecureBuffer& operator=(const uint8_t (&data)[N])
+        { memcpy(storage(), data, N); return *this; }
+    inline SecureBuffer& operator=(uint8_t (&&data)[N])
+        { memcpy(storage(), data, N); return *this; }
     ~SecureBuffer() noexcept;
-    inline uint8_t &operator[](const size_t i) noexcept { return data_[i]; }
-    inline const uint8_t &operator[](const size_t i) const noexcept { return data_[i]; }
-    inline bool operator==(const SecureBuffer &other) const noexcept { return !memcmp(data_, other.data_, N); }
-    inline uint8_t *raw() noexcept { return data_; }
-    inline const uint8_t *raw() const noexcept { return data_; }
-    inline void zero() noexcept { memset(data_, 0, N); }
+    inline uint8_t &operator[](const size_t i) noexcept { return storage()[i]; }
+    inline const uint8_t &operator[](const size_t i) const noexcept { return storage()[i]; }
+    inline bool operator==(const SecureBuffer &other) const noexcept { return !memcmp(storage(), other.storage(), N); }
+    inline uint8_t *raw() noexcept { return storage(); }
+    inline const uint8_t *raw() const noexcept { return storage(); }
+    inline void zero() noexcept { memset(storage(), 0, N); }
     SecureBuffer<N> &operator<<=(const size_t shift) noexcept;
     inline SecureBuffer<N> &operator+=(const SecureBuffer<N> &op) noexcept
-        {std::transform(data_, data_ + N, op.data_, data_, std::bit_xor<uint8_t>()); return *this;}
+        { xorBytes(storage(), op.storage(), N); return *this; }
     inline SecureBuffer<N> &operator+=(const uint8_t (&op)[N]) noexcept
-        {std::transform(data_, data_ + N, op, data_, std::bit_xor<uint8_t>()); return *this;}
+        { xorBytes(storage(), op, N); return *this; }
     struct Iterator;
-    inline Iterator begin() noexcept { return Iterator(data_); }
-    inline Iterator end() noexcept { return Iterator(data_ + N); }
+    inline Iterator begin() noexcept { return Iterator(storage()); }
+    inline Iterator end() noexcept { return Iterator(storage() + N); }
     struct ConstIterator;
-    inline ConstIterator begin() const noexcept { return ConstIterator(data_); }
-    inline ConstIterator end() const noexcept { return ConstIterator(data_ + N); }
-    SecureBuffer<N> &add(const size_t num);
+    inline ConstIterator begin() const noexcept { return ConstIterator(storage()); }
+    inline ConstIterator end() const noexcept { return ConstIterator(storage() + N); }
+    // Порядок байт счётчика: little - младший байт первый (Стрибог),
+    // big - старший байт первый (счётчики CTR и CTR_DRBG).
+    template <std::endian Order = std::endian::little>
+    SecureBuffer<N> &add(const uint64_t num) noexcept;
 };
 
 template <typename... Ts>
 SecureBuffer(Ts...) -> SecureBuffer<sizeof...(Ts)>;
 
+// Вне строки, чтобы проверка в storage() не раздувала горячие пути.
+// Нехватка памяти здесь завершает процесс: аксессоры noexcept.
+template <size_t N>
+void SecureBuffer<N>::allocateMovedFrom() const {
+    data_ = static_cast<uint8_t *>(LockedArena::allocate(N));
+    memset(data_, 0, N);
+}
+
 template <size_t N>
 SecureBuffer<N>::~SecureBuffer() noexcept {
-    thread_local std::random_device rd;
-    thread_local std::mt19937 gen(rd());
-    thread_local std::uniform_int_distribution dist(0, 255);
-    
-    for (size_t i = 0; i < N; ++i)
-        data_[i] = static_cast<uint8_t>(dist(gen));
-    munlock(data_, N);
+    if (!data_) return;
+    secureWipe(data_, N);
+    LockedArena::deallocate(data_, N);
 }
 
+// Сдвиг влево буфера как big-endian числа. Побитовая часть сдвига
+// выполняется 64-битными словами, если N кратно 8.
 template <size_t N>
 SecureBuffer<N> &SecureBuffer<N>::operator<<=(const size_t shift) noexcept {
+    uint8_t *const data = storage();
     if (shift == 0) return *this;
     const size_t total_bits = N * 8;
     if (shift >= total_bits) {
@@ -77,71 +125,62 @@ SecureBuffer<N> &SecureBuffer<N>::operator<<=(const size_t shift) noexcept {
         return *this;
     }
     const size_t byte_shift = shift / 8;
-    const size_t bit_shift = shift % 8;
+    const unsigned bit_shift = shift % 8;
     if (byte_shift > 0) {
-        for (size_t i = 0; i < N - byte_shift; ++i)
-            (*this)[i] = (*this)[i + byte_shift];
-        std::fill(data_ + N - byte_shift, data_ + N, 0);
+        memmove(data, data + byte_shift, N - byte_shift);
+        memset(data + N - byte_shift, 0, byte_shift);
     }
-    if (bit_shift > 0) {
-        for (size_t i = 0; i < N - 1; ++i) {
-            (*this)[i] = ((*this)[i] << bit_shift) | ((*this)[i + 1] >> (8 - bit_shift));
+    if (bit_shift == 0) return *this;
+    if constexpr (N % 8 == 0) {
+        uint64_t current;
+        __builtin_memcpy(&current, data, 8);
+        current = be64toh(current);
+        for (size_t i = 0; i + 8 < N; i += 8) {
+            uint64_t next;
+            __builtin_memcpy(&next, data + i + 8, 8);
+            next = be64toh(next);
+            const uint64_t word = htobe64((current << bit_shift) | (next >> (64 - bit_shift)));
+            __builtin_memcpy(data + i, &word, 8);
+            current = next;
         }
-        (*this)[N - 1] <<= bit_shift;
+        const uint64_t word = htobe64(current << bit_shift);
+        __builtin_memcpy(data + N - 8, &word, 8);
     }
-    return *this;
-}
-
-
-#ifndef SECUREBUFFER_BIG_ENDIAN_COUNTER
-template<size_t N>
-SecureBuffer<N> &SecureBuffer<N>::add(size_t num) {
-    uint16_t carry = 0;
-    size_t i = 0;
-    for (; i < std::min(sizeof(size_t), N) && num; ++i) {
-        carry = static_cast<uint16_t>(
-            static_cast<uint16_t>(data_[i]) +
-            static_cast<uint16_t>(num & 0xFF) +
-            (carry >> 8)
-        );
-        data_[i] = static_cast<uint8_t>(carry);
-        num >>= 8;
-    }
-    carry >>= 8;
-    for (; i < N && carry; ++i) {
-        carry =
-            static_cast<uint16_t>(data_[i]) +
-            carry;
-        data_[i] = static_cast<uint8_t>(carry);
-        carry >>= 8;
+    else {
+        for (size_t i = 0; i < N - 1; ++i)
+            data[i] = static_cast<uint8_t>((data[i] << bit_shift) | (data[i + 1] >> (8 - bit_shift)));
+        data[N - 1] = static_cast<uint8_t>(data[N - 1] << bit_shift);
     }
     return *this;
 }
-#else
-template<size_t N>
-SecureBuffer<N> &SecureBuffer<N>::add(size_t num) {
-    uint16_t carry = 0;
-    size_t i = 0;
-    for (; i < std::min(sizeof(size_t), N) && num; ++i) {
-        carry = static_cast<uint16_t>(
-            static_cast<uint16_t>(data_[N - 1 - i]) +
-            static_cast<uint16_t>(num & 0xFF) +
-            (carry >> 8)
-        );
-        data_[N - 1 - i] = static_cast<uint8_t>(carry);
-        num >>= 8;
+
+// Прибавление num к буферу как к N-байтовому числу с порядком байт Order.
+// Складываются 64-битные слова начиная с младшего, пока есть перенос;
+// старшие N % 8 байт обрабатываются побайтно.
+template <size_t N>
+template <std::endian Order>
+SecureBuffer<N> &SecureBuffer<N>::add(const uint64_t num) noexcept {
+    uint8_t *const data = storage();
+    static_assert(Order == std::endian::little || Order == std::endian::big);
+    static constexpr size_t words = N / 8;
+    uint64_t carry = num;
+    for (size_t i = 0; i < words && carry; ++i) {
+        uint8_t *const ptr = data + (Order == std::endian::little ? 8 * i : N - 8 * (i + 1));
+        uint64_t word;
+        __builtin_memcpy(&word, ptr, 8);
+        word = Order == std::endian::little ? le64toh(word) : be64toh(word);
+        carry = __builtin_add_overflow(word, carry, &word);
+        word = Order == std::endian::little ? htole64(word) : htobe64(word);
+        __builtin_memcpy(ptr, &word, 8);
     }
-    carry >>= 8;
-    for (; i < N && carry; ++i) {
-        carry =
-            static_cast<uint16_t>(data_[N - 1 - i]) +
-            carry;
-        data_[N - 1 - i] = static_cast<uint8_t>(carry);
-        carry >>= 8;
+    for (size_t i = 8 * words; i < N && carry; ++i) {
+        uint8_t &byte = data[Order == std::endian::little ? i : N - 1 - i];
+        const uint64_t sum = byte + (carry & 0xFF);
+        byte = static_cast<uint8_t>(sum);
+        carry = (carry >> 8) + (sum >> 8);
     }
     return *this;
 }
-#endif
 
 template<size_t N>
 struct SecureBuffer<N>::Iterator {
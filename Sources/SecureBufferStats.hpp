@@ -0,0 +1,172 @@
+/*  Счётчики работы с памятью секретов, включаемые при сборке с
+    SECUREBUFFER_STATS. Учитываются выделения LockedArena по классам
+    размеров, вызовы mlock/munlock, затирания и объём живых байт.
+    Счётчики событий ведёт каждый поток отдельно; snapshot() суммирует
+    их по всем потокам, включая завершившиеся. Живые байты и пик -
+    общие на процесс, так как буфер может освобождаться другим потоком.
+    Без SECUREBUFFER_STATS функции учёта пусты, а snapshot() возвращает
+    нули.
+*/
+#ifndef SECURE_BUFFER_STATS_HPP
+#define SECURE_BUFFER_STATS_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+class SecureBufferStats {
+public:
+#ifdef SECUREBUFFER_STATS
+    static constexpr bool enabled = true;
+#else
+    static constexpr bool enabled = false;
+#endif
+    // Классы LockedArena 16, 32, ..., 4096 байт и отдельные отображения.
+    static constexpr size_t MinClass = 16;
+    static constexpr size_t NumClasses = 10;
+
+    struct Snapshot {
+        size_t allocations[NumClasses];
+        size_t lock_calls;
+        size_t locked_bytes;
+        size_t unlock_calls;
+        size_t wipe_calls;
+        size_t wiped_bytes;
+        size_t live_bytes;
+        size_t peak_live_bytes;
+    };
+
+    static inline Snapshot snapshot() noexcept;
+
+    static inline void allocated(const size_t size) noexcept;
+    static inline void deallocated(const size_t size) noexcept;
+    static inline void locked(const size_t size) noexcept;
+    static inline void unlocked() noexcept;
+    static inline void wiped(const size_t size) noexcept;
+private:
+    static constexpr size_t classIndex(const size_t size) noexcept {
+        size_t index = 0;
+        for (size_t class_size = MinClass; class_size < size && index < NumClasses - 1; class_size <<= 1) ++index;
+        return index;
+    }
+
+    struct Counters {
+        std::atomic<size_t> allocations[NumClasses] = {};
+        std::atomic<size_t> lock_calls = 0;
+        std::atomic<size_t> locked_bytes = 0;
+        std::atomic<size_t> unlock_calls = 0;
+        std::atomic<size_t> wipe_calls = 0;
+        std::atomic<size_t> wiped_bytes = 0;
+
+        inline void addTo(Snapshot &snapshot) const noexcept {
+            for (size_t i = 0; i < NumClasses; ++i)
+                snapshot.allocations[i] += allocations[i].load(std::memory_order_relaxed);
+            snapshot.lock_calls += lock_calls.load(std::memory_order_relaxed);
+            snapshot.locked_bytes += locked_bytes.load(std::memory_order_relaxed);
+            snapshot.unlock_calls += unlock_calls.load(std::memory_order_relaxed);
+            snapshot.wipe_calls += wipe_calls.load(std::memory_order_relaxed);
+            snapshot.wiped_bytes += wiped_bytes.load(std::memory_order_relaxed);
+        }
+    };
+
+    struct Global {
+        std::mutex mutex;
+        std::vector<const Counters *> threads;
+        // Итоги завершившихся потоков и события после разрушения
+        // счётчиков потока.
+        Counters retired;
+        std::atomic<size_t> live_bytes = 0;
+        std::atomic<size_t> peak_live_bytes = 0;
+    };
+    // Никогда не разрушается, как и состояние LockedArena.
+    static inline Global &global() {
+        static Global *const instance = new Global();
+        return *instance;
+    }
+
+    struct Local {
+        Counters counters;
+        inline Local();
+        inline ~Local();
+    };
+    static inline thread_local bool local_destroyed_ = false;
+    static inline Counters &local() noexcept {
+        if (local_destroyed_) return global().retired;
+        static thread_local Local instance;
+        return instance.counters;
+    }
+
+    static inline void add(std::atomic<size_t> &counter, const size_t value) noexcept
+        { counter.fetch_add(value, std::memory_order_relaxed); }
+};
+
+inline SecureBufferStats::Local::Local() {
+    Global &g = global();
+    std::lock_guard guard(g.mutex);
+    g.threads.push_back(&counters);
+}
+
+inline SecureBufferStats::Local::~Local() {
+    Global &g = global();
+    std::lock_guard guard(g.mutex);
+    for (size_t i = 0; i < NumClasses; ++i)
+        add(g.retired.allocations[i], counters.allocations[i].load(std::memory_order_relaxed));
+    add(g.retired.lock_calls, counters.lock_calls.load(std::memory_order_relaxed));
+    add(g.retired.locked_bytes, counters.locked_bytes.load(std::memory_order_relaxed));
+    add(g.retired.unlock_calls, counters.unlock_calls.load(std::memory_order_relaxed));
+    add(g.retired.wipe_calls, counters.wipe_calls.load(std::memory_order_relaxed));
+    add(g.retired.wiped_bytes, counters.wiped_bytes.load(std::memory_order_relaxed));
+    g.threads.erase(std::find(g.threads.begin(), g.threads.end(), &counters));
+    local_destroyed_ = true;
+}
+
+inline SecureBufferStats::Snapshot SecureBufferStats::snapshot() noexcept {
+    Snapshot snapshot = {};
+    if constexpr (enabled) {
+        Global &g = global();
+        std::lock_guard guard(g.mutex);
+        g.retired.addTo(snapshot);
+        for (const Counters *counters : g.threads) counters->addTo(snapshot);
+        snapshot.live_bytes = g.live_bytes.load(std::memory_order_relaxed);
+        snapshot.peak_live_bytes = g.peak_live_bytes.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+inline void SecureBufferStats::allocated([[maybe_unused]] const size_t size) noexcept {
+    if constexpr (enabled) {
+        add(local().allocations[classIndex(size)], 1);
+        Global &g = global();
+        const size_t live = g.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        size_t peak = g.peak_live_bytes.load(std::memory_order_relaxed);
+        while (peak < live && !g.peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+}
+
+inline void SecureBufferStats::deallocated([[maybe_unused]] const size_t size) noexcept {
+    if constexpr (enabled) global().live_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+inline void SecureBufferStats::locked([[maybe_unused]] const size_t size) noexcept {
+    if constexpr (enabled) {
+        Counters &c = local();
+        add(c.lock_calls, 1);
+        add(c.locked_bytes, size);
+    }
+}
+
+inline void SecureBufferStats::unlocked() noexcept {
+    if constexpr (enabled) add(local().unlock_calls, 1);
+}
+
+inline void SecureBufferStats::wiped([[maybe_unused]] const size_t size) noexcept {
+    if constexpr (enabled) {
+        Counters &c = local();
+        add(c.wipe_calls, 1);
+        add(c.wiped_bytes, size);
+    }
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*  Байтовый буфер переменной длины для секретных данных.
+    Память берётся из LockedArena через SecureAllocator, поэтому
+    остаётся заблокированной без системных вызовов на каждый объект.
+    Освобождаемая память (при росте, shrink_to_fit и разрушении)
+    затирается целиком, отбрасываемый хвост при resize/clear/pop_back -
+    сразу. Перемещение передаёт владение памятью без копирования.
+*/
+#ifndef SECURE_VECTOR_HPP
+#define SECURE_VECTOR_HPP
+
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+#include <vector>
+#include "LockedArena.hpp"
+#include "SecureWipe.hpp"
+
+template <typename T>
+struct SecureAllocator {
+    using value_type = T;
+
+    SecureAllocator() noexcept = default;
+    template <typename U>
+    inline SecureAllocator(const SecureAllocator<U> &) noexcept {}
+
+    inline T *allocate(const size_t n)
+        { return static_cast<T *>(LockedArena::allocate(n * sizeof(T))); }
+    inline void deallocate(T *ptr, const size_t n) noexcept {
+        secureWipe(ptr, n * sizeof(T));
+        LockedArena::deallocate(ptr, n * sizeof(T));
+    }
+    // Элементы без аргументов не обнуляются: SecureVector обнуляет
+    // явно, а uninitialized() оставляет память под перезапись.
+    template <typename U>
+    inline void construct(U *ptr) noexcept { ::new (static_cast<void *>(ptr)) U; }
+    template <typename U, typename... Args>
+    inline void construct(U *ptr, Args &&...args)
+        { std::construct_at(ptr, std::forward<Args>(args)...); }
+    friend inline bool operator==(const SecureAllocator &, const SecureAllocator &) noexcept { return true; }
+};
+
+class SecureVector {
+private:
+    using Storage = std::vector<uint8_t, SecureAllocator<uint8_t>>;
+    Storage data_;
+public:
+    using value_type = uint8_t;
+    using size_type = size_t;
+    using iterator = Storage::iterator;
+    using const_iterator = Storage::const_iterator;
+
+    SecureVector() noexcept = default;
+    inline explicit SecureVector(const size_t size) : data_(size, 0) {}
+    inline SecureVector(std::initializer_list<uint8_t> init) : data_(init) {}
+    template <std::input_iterator It>
+    inline SecureVector(It first, It last) : data_(first, last) {}
+    inline explicit SecureVector(const std::span<const uint8_t> data) : data_(data.begin(), data.end()) {}
+    // Буфер, который вызывающий сразу перезапишет целиком.
+    static inline SecureVector uninitialized(const size_t size) {
+        SecureVector result;
+        result.data_.resize(size);
+        return result;
+    }
+
+    inline uint8_t *data() noexcept { return data_.data(); }
+    inline const uint8_t *data() const noexcept { return data_.data(); }
+    inline size_t size() const noexcept { return data_.size(); }
+    inline size_t capacity() const noexcept { return data_.capacity(); }
+    inline bool empty() const noexcept { return data_.empty(); }
+    inline uint8_t &operator[](const size_t i) noexcept { return data_[i]; }
+    inline const uint8_t &operator[](const size_t i) const noexcept { return data_[i]; }
+    inline iterator begin() noexcept { return data_.begin(); }
+    inline iterator end() noexcept { return data_.end(); }
+    inline const_iterator begin() const noexcept { return data_.begin(); }
+    inline const_iterator end() const noexcept { return data_.end(); }
+
+    inline void reserve(const size_t capacity) { data_.reserve(capacity); }
+    inline void shrink_to_fit() { data_.shrink_to_fit(); }
+    inline void resize(const size_t size) {
+        if (size < data_.size()) secureWipe(data_.data() + size, data_.size() - size);
+        data_.resize(size, 0);
+    }
+    inline void clear() noexcept { resize(0); }
+    inline void push_back(const uint8_t byte) { data_.push_back(byte); }
+    inline void pop_back() noexcept { resize(data_.size() - 1); }
+    template <std::input_iterator It>
+    inline iterator insert(const const_iterator pos, It first, It last) { return data_.insert(pos, first, last); }
+    template <std::input_iterator It>
+    inline void assign(It first, It last) { clear(); data_.assign(first, last); }
+
+    friend inline bool operator==(const SecureVector &a, const std::span<const uint8_t> b) noexcept
+        { return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin()); }
+};
+
+#endif
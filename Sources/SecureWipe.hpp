@@ -0,0 +1,114 @@
+/*  Затирание памяти с ключевой информацией.
+    По умолчанию память обнуляется через explicit_bzero, вызов которого
+    компилятор не удаляет как "мёртвую" запись. При определённом
+    SECUREBUFFER_RANDOM_WIPE память заполняется потоком ChaCha20
+    (RFC 8439) машинными словами; ключ потока берётся из getrandom()
+    один раз на поток. Когда при завершении потока генератор уже
+    разрушен (его деструктор обнуляет состояние), затирание из деструкторов
+    других thread_local-объектов выполняется через explicit_bzero.
+*/
+#ifndef SECURE_WIPE_HPP
+#define SECURE_WIPE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string.h>
+#include <sys/random.h>
+#include "SecureBufferStats.hpp"
+
+class WipeStream {
+private:
+    uint32_t state_[16];
+    uint64_t block_[8];
+    size_t position_ = 8;
+
+    struct Local;
+    // Флаг тривиально разрушаемый, поэтому остаётся доступным после
+    // разрушения генератора при завершении потока.
+    static inline thread_local bool destroyed_ = false;
+
+    static constexpr uint32_t rotl(const uint32_t x, const int n) noexcept
+        { return (x << n) | (x >> (32 - n)); }
+    static constexpr void quarterRound(uint32_t &a, uint32_t &b, uint32_t &c, uint32_t &d) noexcept {
+        a += b; d ^= a; d = rotl(d, 16);
+        c += d; b ^= c; b = rotl(b, 12);
+        a += b; d ^= a; d = rotl(d, 8);
+        c += d; b ^= c; b = rotl(b, 7);
+    }
+
+    inline void nextBlock() noexcept {
+        uint32_t x[16];
+        memcpy(x, state_, sizeof(x));
+        for (int round = 0; round < 10; ++round) {
+            quarterRound(x[0], x[4], x[8], x[12]);
+            quarterRound(x[1], x[5], x[9], x[13]);
+            quarterRound(x[2], x[6], x[10], x[14]);
+            quarterRound(x[3], x[7], x[11], x[15]);
+            quarterRound(x[0], x[5], x[10], x[15]);
+            quarterRound(x[1], x[6], x[11], x[12]);
+            quarterRound(x[2], x[7], x[8], x[13]);
+            quarterRound(x[3], x[4], x[9], x[14]);
+        }
+        for (size_t i = 0; i < 16; ++i) x[i] += state_[i];
+        memcpy(block_, x, sizeof(block_));
+        explicit_bzero(x, sizeof(x));
+        if (!++state_[12]) ++state_[13];
+        position_ = 0;
+    }
+public:
+    inline WipeStream() noexcept {
+        state_[0] = 0x61707865; state_[1] = 0x3320646e;
+        state_[2] = 0x79622d32; state_[3] = 0x6b206574;
+        // Ключ и nonce. Если getrandom() недоступен, затирание остаётся
+        // корректным: важен факт перезаписи, а не непредсказуемость.
+        memset(state_ + 4, 0, 48);
+        [[maybe_unused]] const ssize_t got = getrandom(state_ + 4, 32, GRND_NONBLOCK);
+    }
+    inline ~WipeStream() { explicit_bzero(this, sizeof(*this)); }
+
+    inline uint64_t next() noexcept {
+        if (position_ == 8) nextBlock();
+        return block_[position_++];
+    }
+
+    // Генератор текущего потока; nullptr, если он уже разрушен.
+    static inline WipeStream *local() noexcept;
+};
+
+struct WipeStream::Local {
+    WipeStream stream;
+    inline ~Local() { destroyed_ = true; }
+};
+
+inline WipeStream *WipeStream::local() noexcept {
+    if (destroyed_) [[unlikely]] return nullptr;
+    static thread_local Local instance;
+    return &instance.stream;
+}
+
+inline void secureWipe(void *ptr, const size_t size) noexcept {
+    SecureBufferStats::wiped(size);
+#ifdef SECUREBUFFER_RANDOM_WIPE
+    WipeStream *const stream = WipeStream::local();
+    if (!stream) [[unlikely]] {
+        explicit_bzero(ptr, size);
+        return;
+    }
+    uint8_t *data = static_cast<uint8_t *>(ptr);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        const uint64_t word = stream->next();
+        __builtin_memcpy(data + i, &word, sizeof(uint64_t));
+    }
+    if (i < size) {
+        const uint64_t word = stream->next();
+        memcpy(data + i, &word, size - i);
+    }
+    // Барьер: запись считается наблюдаемой, и компилятор её не удалит.
+    asm volatile("" : : "r"(ptr) : "memory");
+#else
+    explicit_bzero(ptr, size);
+#endif
+}
+
+#endif
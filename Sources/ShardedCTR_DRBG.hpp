@@ -0,0 +1,119 @@
+/*  Шардированный CTR_DRBG: каждый поток получает собственный экземпляр
+    ПДСЧ, поэтому запросы из разных потоков не блокируют друг друга
+    и не разделяют состояние. Экземпляры засеваются независимо, строка
+    персонализации каждого дополняется номером шарда. reseedAll()
+    увеличивает эпоху, и каждый шард пересеивается при следующем запросе.
+    При PoolSize > 0 каждый шард буферизуется (BufferedCTR_DRBG).
+    Без TBB используется один экземпляр под мьютексом.
+*/
+#ifndef SHARDED_CTR_DRBG_HPP
+#define SHARDED_CTR_DRBG_HPP
+
+#include <atomic>
+#include <vector>
+
+#ifndef DONT_USE_TBB
+#include <tbb/enumerable_thread_specific.h>
+#else
+#include <mutex>
+#endif
+
+#include "BufferedCTR_DRBG.hpp"
+
+template <
+    IsCipher CipherType,
+    bool AutoReseed = false,
+    IsEntropySource<CipherType::BlockSize + CipherType::KeySize> EntropySourceType =
+        GetrandomSource<CipherType::BlockSize + CipherType::KeySize>,
+    size_t PoolSize = 0
+>
+class ShardedCTR_DRBG {
+private:
+    using DRBG = std::conditional_t<PoolSize == 0,
+        CTR_DRBG<CipherType, AutoReseed, EntropySourceType>,
+        BufferedCTR_DRBG<CTR_DRBG<CipherType, AutoReseed, EntropySourceType>, PoolSize>>;
+    static constexpr size_t SeedLen = CipherType::BlockSize + CipherType::KeySize;
+
+    struct Shard {
+        DRBG drbg;
+        uint64_t epoch;
+        inline Shard(const uint8_t *personalization_string, const size_t len, const uint64_t epoch) :
+            drbg(personalization_string, len), epoch(epoch) {}
+    };
+
+    std::vector<uint8_t> personalization_string_;
+    std::atomic<uint64_t> next_shard_ = 0;
+    std::atomic<uint64_t> epoch_ = 0;
+#ifndef DONT_USE_TBB
+    tbb::enumerable_thread_specific<Shard> shards_;
+#else
+    std::mutex mutex_;
+    Shard shard_;
+#endif
+
+    inline Shard makeShard() {
+        // Первые 8 байт - номер шарда, далее персонализация пользователя.
+        // CTR_DRBG использует не более SeedLen байт персонализации.
+        const size_t user_len = std::min(personalization_string_.size(), SeedLen - 8);
+        std::vector<uint8_t> personalization(8 + user_len);
+        const uint64_t index = htobe64(next_shard_++);
+        memcpy(personalization.data(), &index, 8);
+        std::copy_n(personalization_string_.begin(), user_len, personalization.begin() + 8);
+        return Shard(personalization.data(), personalization.size(), epoch_);
+    }
+
+    inline DRBG &local() {
+#ifndef DONT_USE_TBB
+        Shard &shard = shards_.local();
+#else
+        Shard &shard = shard_;
+#endif
+        const uint64_t epoch = epoch_;
+        if (shard.epoch != epoch) {
+            shard.drbg.reseed();
+            shard.epoch = epoch;
+        }
+        return shard.drbg;
+    }
+public:
+    inline ShardedCTR_DRBG(
+        const uint8_t *personalization_string = nullptr,
+        const size_t personalization_string_len = 0
+    ) :
+        personalization_string_(personalization_string, personalization_string + personalization_string_len),
+#ifndef DONT_USE_TBB
+        shards_([this] { return makeShard(); })
+#else
+        shard_(makeShard())
+#endif
+    {}
+    ShardedCTR_DRBG(const ShardedCTR_DRBG &) = delete;
+    ShardedCTR_DRBG &operator=(const ShardedCTR_DRBG &) = delete;
+
+    inline void operator()(
+        uint8_t *buffer, const size_t size,
+        const uint8_t *additional_input = nullptr,
+        const size_t additional_input_len = 0
+    ) {
+#ifdef DONT_USE_TBB
+        std::lock_guard lock(mutex_);
+#endif
+        local()(buffer, size, additional_input, additional_input_len);
+    }
+    inline uint64_t uint64(
+        const uint8_t *additional_input = nullptr,
+        const size_t additional_input_len = 0
+    ) {
+        uint64_t result;
+        (*this)(reinterpret_cast<uint8_t *>(&result), 8, additional_input, additional_input_len);
+        return result;
+    }
+    // Шарды пересеиваются лениво, в своих потоках.
+    inline void reseedAll() noexcept {
+        LOG(INFO) << "Запрошено пересеивание всех шардов ПДСЧ";
+        ++epoch_;
+    }
+    inline size_t shards() const noexcept { return next_shard_; }
+};
+
+#endif
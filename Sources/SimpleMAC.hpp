@@ -18,7 +18,7 @@ private:
     inline void finalize() { memset(buffer_.raw() + buffered_length_, 0, Size - buffered_length_); result_ += buffer_; }
 public:
     SimpleMAC() : buffered_length_(0) {}
-    inline void initKeySchedule(const SecureBuffer<Size> &key) noexcept override { key_ = key; result_ = key; }
+    inline void initKeySchedule(const SecureBuffer<Size> &key) noexcept override { key_ = key; result_ = key; buffered_length_ = 0; }
     inline SimpleMAC(const SecureBuffer<Size> &key) noexcept : SimpleMAC() { initKeySchedule(key); }
     void update(const uint8_t *data, const size_t size) noexcept override;
     inline void update(const std::vector<uint8_t> &data) noexcept override
@@ -29,6 +29,11 @@ public:
         { finalize(); memcpy(digest_buffer, result_.raw(), Size); }
     inline void clear() noexcept override
         { result_ = key_; buffered_length_ = 0; }
+    // Стирание ключа и состояния; до initKeySchedule контекст непригоден.
+    inline void wipe() noexcept {
+        secureWipe(key_.raw(), Size); secureWipe(result_.raw(), Size);
+        secureWipe(buffer_.raw(), Size); buffered_length_ = 0;
+    }
 
     static constexpr size_t BlockSize = Size;
     static constexpr size_t DigestSize = Size;
@@ -43,9 +48,15 @@ void SimpleMAC<Size>::update(const uint8_t *data, const size_t size) noexcept {
             buffered_length_ = 0;
             result_ += buffer_;
         }
-        uint8_t to_copy = static_cast<uint8_t>(
-            std::min(static_cast<size_t>(Size - buffered_length_), size - current_index)
-        );
+        // Полные блоки складываются с результатом напрямую, минуя буфер.
+        if (buffered_length_ == 0 && size - current_index > Size) {
+            const size_t full = ((size - current_index - 1) / Size) * Size;
+            for (size_t i = 0; i < full; i += Size)
+                xorBytes(result_.raw(), data + current_index + i, Size);
+            current_index += full;
+            continue;
+        }
+        size_t to_copy = std::min(Size - buffered_length_, size - current_index);
         std::copy(
             data + static_cast<ptrdiff_t>(current_index),
             data + static_cast<ptrdiff_t>(current_index + to_copy),
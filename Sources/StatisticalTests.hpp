@@ -0,0 +1,105 @@
+/*  Быстрые статистические тесты выхода ПДСЧ:
+      монобитный тест и тест на серии из NIST SP 800-22 (2.1, 2.3),
+      покер-тест из FIPS 140-2 (4-битные блоки, хи-квадрат с 15
+      степенями свободы).
+    Каждый тест возвращает p-значение; последовательность считается
+    случайной при p >= alpha (обычно 0.01). Биты нумеруются от
+    старшего бита первого байта, как последовательность ε в SP 800-22.
+*/
+#ifndef STATISTICAL_TESTS_HPP
+#define STATISTICAL_TESTS_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+namespace statistical_tests {
+
+inline bool bit(const uint8_t *data, const size_t i) noexcept
+    { return (data[i / 8] >> (7 - i % 8)) & 1; }
+
+// Верхняя регуляризованная неполная гамма-функция Q(a, x).
+inline double igamc(const double a, const double x) noexcept {
+    if (x <= 0) return 1;
+    const double log_prefix = a * std::log(x) - x - std::lgamma(a);
+    if (x < a + 1) {
+        // Ряд для P(a, x).
+        double term = 1 / a, sum = term;
+        for (double n = 1; n < 1000 && std::fabs(term) > std::fabs(sum) * 1e-15; ++n) {
+            term *= x / (a + n);
+            sum += term;
+        }
+        return 1 - sum * std::exp(log_prefix);
+    }
+    // Цепная дробь для Q(a, x) (метод Ленца).
+    static constexpr double tiny = 1e-300;
+    double b = x + 1 - a, c = 1 / tiny, d = 1 / b, h = d;
+    for (double i = 1; i < 1000; ++i) {
+        const double an = -i * (i - a);
+        b += 2;
+        d = an * d + b;
+        if (std::fabs(d) < tiny) d = tiny;
+        c = b + an / c;
+        if (std::fabs(c) < tiny) c = tiny;
+        d = 1 / d;
+        const double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1) < 1e-15) break;
+    }
+    return std::exp(log_prefix) * h;
+}
+
+inline size_t countOnes(const uint8_t *data, const size_t bits) noexcept {
+    size_t ones = 0;
+    for (size_t i = 0; i < bits / 8; ++i)
+        ones += static_cast<size_t>(__builtin_popcount(data[i]));
+    for (size_t i = bits / 8 * 8; i < bits; ++i)
+        ones += bit(data, i);
+    return ones;
+}
+
+inline double monobit(const uint8_t *data, const size_t bits) noexcept {
+    const double n = static_cast<double>(bits);
+    const double sum = 2 * static_cast<double>(countOnes(data, bits)) - n;
+    return std::erfc(std::fabs(sum) / std::sqrt(2 * n));
+}
+
+inline double runs(const uint8_t *data, const size_t bits) noexcept {
+    const double n = static_cast<double>(bits);
+    const double pi = static_cast<double>(countOnes(data, bits)) / n;
+    // Предварительный монобитный критерий из SP 800-22.
+    if (std::fabs(pi - 0.5) >= 2 / std::sqrt(n)) return 0;
+    size_t changes = 1;
+    for (size_t i = 1; i < bits; ++i)
+        changes += bit(data, i) != bit(data, i - 1);
+    const double v = static_cast<double>(changes);
+    return std::erfc(std::fabs(v - 2 * n * pi * (1 - pi)) / (2 * std::sqrt(2 * n) * pi * (1 - pi)));
+}
+
+inline double poker(const uint8_t *data, const size_t bits) noexcept {
+    size_t counts[16] = {};
+    const size_t blocks = bits / 4;
+    for (size_t i = 0; i < blocks; ++i)
+        ++counts[(data[i / 2] >> (i % 2 ? 0 : 4)) & 0x0F];
+    double sum = 0;
+    for (const size_t count : counts)
+        sum += static_cast<double>(count) * static_cast<double>(count);
+    const double k = static_cast<double>(blocks);
+    const double chi_square = 16 / k * sum - k;
+    return igamc(15.0 / 2, chi_square / 2);
+}
+
+struct Report {
+    double monobit;
+    double runs;
+    double poker;
+    inline bool passed(const double alpha = 0.01) const noexcept
+        { return monobit >= alpha && runs >= alpha && poker >= alpha; }
+};
+
+inline Report run(const uint8_t *data, const size_t size) noexcept
+    { return {monobit(data, size * 8), runs(data, size * 8), poker(data, size * 8)}; }
+
+}
+
+#endif
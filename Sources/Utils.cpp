@@ -63,10 +63,10 @@ void initKuznechikOMACCTX(OMAC<Kuznechik> &ctx, const char *filename) {
     ctx.initKeySchedule(key);
 }
 
-std::vector<uint8_t> parseHexString(const std::string& hex) {
+SecureVector parseHexString(const std::string& hex) {
     if (hex.length() % 2 != 0)
         throw crispex::invalid_argument("Hex-строка должна иметь чётную длину.");
-    std::vector<uint8_t> result;
+    SecureVector result;
     result.reserve(hex.length() / 2);
     for (size_t i = 0; i < hex.length(); i += 2) {
         uint8_t byte = static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16));
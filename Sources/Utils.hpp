@@ -1,8 +1,12 @@
 #ifndef LAB1_UTILS_HPP
 #define LAB1_UTILS_HPP
 
+#include <cstdlib>
+#include <string>
+
 #include "Kuznechik.hpp"
 #include "OMAC.hpp"
+#include "SecureVector.hpp"
 
 #define BUFFER_SIZE 65536
 
@@ -11,7 +15,7 @@ void checkTimestamp(const uint64_t timestamp_raw) noexcept;
 void getAndCheckKey(const char *filename, MasterKeySecureBuffer<32> &key);
 void initKuznechikOMACCTX(OMAC<Kuznechik> &ctx, const char *filename);
 bool checkModeParam(const char *mode_param, bool &encrypt);
-std::vector<uint8_t> parseHexString(const std::string& hex);
+SecureVector parseHexString(const std::string& hex);
 std::string toHexString(const std::vector<uint8_t> &data) noexcept;
 bool fillBuffer(std::ifstream &file, std::vector<uint8_t> &buffer) noexcept;
 
@@ -27,4 +31,31 @@ inline void confLog(bool stdout_logging = false, bool file_loging = false, const
     el::Loggers::reconfigureLogger("default", conf);
 }
 
+// Политика LockedMemoryBudget по значению параметра командной строки.
+inline LockedMemoryPolicy parseLockedMemoryPolicy(const std::string &str) {
+    if (str == "fail") return LockedMemoryPolicy::Fail;
+    if (str == "wait") return LockedMemoryPolicy::Wait;
+    if (str == "unlocked") return LockedMemoryPolicy::Unlocked;
+    throw crispex::invalid_argument("Неизвестная политика заблокированной памяти: " + str);
+}
+
+// Итоги SecureBufferStats в журнал; регистрируется через std::atexit.
+inline void logSecureBufferStats() noexcept {
+    if constexpr (SecureBufferStats::enabled) {
+        const SecureBufferStats::Snapshot stats = SecureBufferStats::snapshot();
+        std::string allocations;
+        for (size_t i = 0; i < SecureBufferStats::NumClasses; ++i) {
+            allocations += i + 1 < SecureBufferStats::NumClasses
+                ? " " + std::to_string(SecureBufferStats::MinClass << i) + ":"
+                : " >" + std::to_string(SecureBufferStats::MinClass << (i - 1)) + ":";
+            allocations += std::to_string(stats.allocations[i]);
+        }
+        LOG(INFO) << "SecureBuffer: выделения по классам" << allocations
+                  << "; mlock " << stats.lock_calls << " (" << stats.locked_bytes << " байт)"
+                  << ", munlock " << stats.unlock_calls
+                  << "; затирания " << stats.wipe_calls << " (" << stats.wiped_bytes << " байт)"
+                  << "; живых байт " << stats.live_bytes << ", пик " << stats.peak_live_bytes;
+    }
+}
+
 #endif
\ No newline at end of file
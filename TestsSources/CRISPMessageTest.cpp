@@ -2,7 +2,7 @@
 #include <iomanip>
 #include "CRISPMessage.hpp"
 
-std::string toHex(const std::vector<uint8_t>& data) {
+std::string toHex(const std::span<const uint8_t> data) {
     std::ostringstream oss;
     oss << std::hex << std::uppercase << std::setfill('0');
     for (uint8_t b : data)
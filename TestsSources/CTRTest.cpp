@@ -1,6 +1,5 @@
 #include <gtest/gtest.h>
 #include <vector>
-#define SECUREBUFFER_BIG_ENDIAN_COUNTER
 #include "Kuznechik.hpp"
 #include "CTR.hpp"
 
@@ -82,6 +81,164 @@ TEST(CTR, Decrypt) {
     );
 }
 
+static const Kuznechik test_cipher({
+    0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+    0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10,
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef
+});
+static constexpr uint8_t test_IV[] = {
+    0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xce, 0xf0,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static std::vector<uint8_t> testData(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i)
+        data[i] = static_cast<uint8_t>(i * 7 + 3);
+    return data;
+}
+
+TEST(CTR, EncryptPartialBlock) {
+    // Последний неполный блок шифруется на счётчике IV + номер блока.
+    std::vector<uint8_t> full = testData(64);
+    std::vector<uint8_t> prefix(full.begin(), full.begin() + 40);
+    CTREncrypt(test_cipher, full.data(), full.size(), test_IV);
+    CTREncrypt(test_cipher, prefix.data(), prefix.size(), test_IV);
+    EXPECT_EQ(prefix, std::vector(full.begin(), full.begin() + 40));
+}
+
+TEST(CTR, EncryptPartialBlockKnownAnswer) {
+    // Первые 40 байт примера ГОСТ Р 34.13-2018: третий блок неполный
+    // и шифруется старшими байтами гаммы на счётчике IV + 2.
+    uint8_t text[] = {
+        0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00,
+        0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88,
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xee, 0xff, 0x0a,
+        0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88
+    };
+    static constexpr uint8_t cipher_text[] = {
+        0xf1, 0x95, 0xd8, 0xbe, 0xc1, 0x0e, 0xd1, 0xdb,
+        0xd5, 0x7b, 0x5f, 0xa2, 0x40, 0xbd, 0xa1, 0xb8,
+        0x85, 0xee, 0xe7, 0x33, 0xf6, 0xa1, 0x3e, 0x5d,
+        0xf3, 0x3c, 0xe4, 0xb3, 0x3c, 0x45, 0xde, 0xe4,
+        0xa5, 0xea, 0xe8, 0x8b, 0xe6, 0x35, 0x6e, 0xd3
+    };
+    CTREncrypt(test_cipher, text, sizeof(text), test_IV);
+    EXPECT_EQ(std::vector(text, text + sizeof(text)), std::vector(cipher_text, cipher_text + sizeof(cipher_text)));
+}
+
+TEST(CTR, EncryptOutOfPlace) {
+    for (const size_t size : std::initializer_list<size_t>{0, 15, 64, 4133}) {
+        std::vector<uint8_t> expected = testData(size);
+        CTREncrypt(test_cipher, expected.data(), expected.size(), test_IV);
+        const std::vector<uint8_t> plain = testData(size);
+        std::vector<uint8_t> actual(size);
+        CTREncrypt<16, 32>(test_cipher, plain, actual, test_IV);
+        EXPECT_EQ(actual, expected) << "size = " << size;
+        EXPECT_EQ(plain, testData(size));
+    }
+    const std::vector<uint8_t> plain = testData(64);
+    std::vector<uint8_t> small(63);
+    EXPECT_THROW((CTREncrypt<16, 32>(test_cipher, plain, small, test_IV)), crispex::invalid_argument);
+}
+
+TEST(CTR, StreamArbitrarySplits) {
+    std::vector<uint8_t> expected = testData(4133);
+    CTREncrypt(test_cipher, expected.data(), expected.size(), test_IV);
+    for (const size_t chunk : std::initializer_list<size_t>{1, 5, 15, 16, 17, 100, 2049}) {
+        const std::vector<uint8_t> plain = testData(4133);
+        std::vector<uint8_t> actual(plain.size());
+        CTRStream<Kuznechik> stream(test_cipher, test_IV);
+        for (size_t offset = 0; offset < plain.size(); offset += chunk) {
+            const size_t len = std::min(chunk, plain.size() - offset);
+            stream.update(plain.data() + offset, actual.data() + offset, len);
+        }
+        EXPECT_EQ(stream.tell(), plain.size());
+        EXPECT_EQ(actual, expected) << "chunk = " << chunk;
+    }
+}
+
+TEST(CTR, StreamInPlace) {
+    std::vector<uint8_t> expected = testData(1000);
+    CTREncrypt(test_cipher, expected.data(), expected.size(), test_IV);
+    std::vector<uint8_t> actual = testData(1000);
+    CTRStream<Kuznechik> stream(test_cipher, test_IV);
+    stream.update(actual.data(), actual.data(), 333);
+    stream.update(actual.data() + 333, actual.data() + 333, 667);
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(CTR, StreamSeek) {
+    std::vector<uint8_t> expected = testData(1000);
+    CTREncrypt(test_cipher, expected.data(), expected.size(), test_IV);
+    const std::vector<uint8_t> plain = testData(1000);
+    for (const size_t offset : std::initializer_list<size_t>{0, 7, 16, 500, 997}) {
+        std::vector<uint8_t> actual(plain.size() - offset);
+        CTRStream<Kuznechik> stream(test_cipher, test_IV);
+        stream.seek(offset);
+        stream.update(plain.data() + offset, actual.data(), 3);
+        stream.update(plain.data() + offset + 3, actual.data() + 3, actual.size() - 3);
+        EXPECT_EQ(actual, std::vector(expected.begin() + static_cast<std::ptrdiff_t>(offset), expected.end()))
+            << "offset = " << offset;
+    }
+}
+
+TEST(CTR, CounterCarry) {
+    // Перенос из младшего 64-битного слова счётчика в старшее.
+    static constexpr uint8_t IV[] = {
+        0x12, 0x34, 0x56, 0x78, 0x90, 0xab, 0xce, 0xf0,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe
+    };
+    std::vector<uint8_t> actual = testData(80);
+    std::vector<uint8_t> expected = testData(80);
+    CTREncrypt(test_cipher, actual.data(), actual.size(), IV);
+    SecureBuffer<16> counter(IV);
+    for (size_t i = 0; i < 5; ++i) {
+        SecureBuffer<16> block(counter);
+        test_cipher.encrypt(block);
+        for (size_t j = 0; j < 16; ++j)
+            expected[i * 16 + j] ^= block[j];
+        counter.add<std::endian::big>(1);
+    }
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(CTR, StreamPrecompute) {
+    std::vector<uint8_t> expected = testData(3000);
+    CTREncrypt(test_cipher, expected.data(), expected.size(), test_IV);
+    const std::vector<uint8_t> plain = testData(3000);
+    std::vector<uint8_t> actual(plain.size());
+    CTRStream<Kuznechik> stream(test_cipher, test_IV);
+    size_t offset = 0;
+    for (const size_t len : std::initializer_list<size_t>{3, 29, 600, 1, 2367}) {
+        stream.precompute();
+        stream.update(plain.data() + offset, actual.data() + offset, len);
+        offset += len;
+    }
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(CTR, ParallelPolicyDoesNotChangeOutput) {
+    std::vector<uint8_t> expected = testData(100000);
+    CTREncrypt(test_cipher, expected.data(), expected.size(), test_IV);
+    const ParallelPolicy::Settings defaults = ParallelPolicy::settings();
+    for (const ParallelPolicy::Settings settings : {
+        ParallelPolicy::Settings{0, 1, 0},
+        ParallelPolicy::Settings{0, 7, 2},
+        ParallelPolicy::Settings{1 << 20, 128, 0}
+    }) {
+        ParallelPolicy::configure(settings);
+        std::vector<uint8_t> actual = testData(100000);
+        CTREncrypt(test_cipher, actual.data(), actual.size(), test_IV);
+        EXPECT_EQ(actual, expected);
+    }
+    ParallelPolicy::calibrate(test_cipher);
+    EXPECT_GE(ParallelPolicy::settings().grain, 1);
+    ParallelPolicy::configure(defaults);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -2,7 +2,14 @@
 #include <openssl/evp.h>
 #include <array>
 #include <iomanip>
+#include <latch>
+#include <set>
+#include <thread>
 #include "CTR_DRBG.hpp"
+#include "ShardedCTR_DRBG.hpp"
+#include "BufferedCTR_DRBG.hpp"
+#include "AsyncEntropySource.hpp"
+#include "StatisticalTests.hpp"
 
 INITIALIZE_EASYLOGGINGPP
 
@@ -2446,6 +2453,247 @@ TEST(CTRDRBGTest, MaxBytesPerRequestExceed) {
     EXPECT_THROW(rng(nullptr, 1 << 20), crispex::rbg_query_limit);
 }
 
+template <size_t SeedLen>
+class ConstantEntropySource : public EntropySource<SeedLen> {
+public:
+    SecureBuffer<SeedLen> operator()() const override {
+        SecureBuffer<SeedLen> entropy;
+        std::fill(entropy.begin(), entropy.end(), 0x5A);
+        return entropy;
+    }
+};
+
+static std::vector<uint8_t> shardPersonalization(const uint64_t index, const std::string &personalization) {
+    std::vector<uint8_t> result(8 + personalization.size());
+    for (size_t i = 0; i < 8; ++i)
+        result[7 - i] = static_cast<uint8_t>(index >> (8 * i));
+    std::copy(personalization.begin(), personalization.end(), result.begin() + 8);
+    return result;
+}
+
+TEST(ShardedCTRDRBGTest, ShardMatchesPersonalizedDRBG) {
+    const std::string personalization = "sharded";
+    ShardedCTR_DRBG<OpenSSLAES256, false, ConstantEntropySource<48>> sharded(
+        reinterpret_cast<const uint8_t *>(personalization.data()), personalization.size());
+    const std::vector<uint8_t> expected_personalization = shardPersonalization(0, personalization);
+    CTR_DRBG<OpenSSLAES256, false, ConstantEntropySource<48>> plain(
+        expected_personalization.data(), expected_personalization.size());
+    std::array<uint8_t, 64> actual, expected;
+    sharded(actual.data(), 64);
+    plain(expected.data(), 64);
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(ShardedCTRDRBGTest, ThreadsGetDistinctShards) {
+    // Одинаковая энтропия у всех шардов: различие обеспечивает номер шарда.
+    ShardedCTR_DRBG<OpenSSLAES256, false, ConstantEntropySource<48>> rng;
+    std::array<uint8_t, 32> first, second;
+    std::latch both_started(2);
+    std::thread t1([&] { both_started.arrive_and_wait(); rng(first.data(), 32); });
+    std::thread t2([&] { both_started.arrive_and_wait(); rng(second.data(), 32); });
+    t1.join(); t2.join();
+    EXPECT_NE(first, second);
+#ifndef DONT_USE_TBB
+    EXPECT_EQ(rng.shards(), 2);
+#endif
+}
+
+TEST(ShardedCTRDRBGTest, ReseedAll) {
+    ShardedCTR_DRBG<OpenSSLAES256, false, ConstantEntropySource<48>> sharded;
+    const std::vector<uint8_t> personalization = shardPersonalization(0, "");
+    CTR_DRBG<OpenSSLAES256, false, ConstantEntropySource<48>> plain(personalization.data(), personalization.size());
+    std::array<uint8_t, 64> actual, expected;
+    sharded(actual.data(), 64);
+    plain(expected.data(), 64);
+    sharded.reseedAll();
+    plain.reseed();
+    sharded(actual.data(), 64);
+    plain(expected.data(), 64);
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(ShardedCTRDRBGTest, ConcurrentSaltsAreUnique) {
+    ShardedCTR_DRBG<OpenSSLAES256, true> rng;
+    std::vector<std::array<uint8_t, 32>> salts(1024);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 8; ++t)
+        threads.emplace_back([&, t] {
+            for (size_t i = t; i < salts.size(); i += 8)
+                rng(salts[i].data(), 32);
+        });
+    for (auto &thread : threads) thread.join();
+    EXPECT_EQ(std::set(salts.begin(), salts.end()).size(), salts.size());
+}
+
+TEST(BufferedCTRDRBGTest, SlicesMatchPoolRequests) {
+    using DRBG = CTR_DRBG<OpenSSLAES256, false, ConstantEntropySource<48>>;
+    static constexpr uint8_t additional_input[] = {'s', 'a', 'l', 't'};
+    BufferedCTR_DRBG<DRBG, 256> buffered;
+    DRBG plain;
+    std::array<uint8_t, 512> expected, actual;
+    plain(expected.data(), 256, additional_input, sizeof(additional_input));
+    plain(expected.data() + 256, 256);
+    // Дополнительный вход первого запроса применяется при первом пополнении пула.
+    buffered(actual.data(), 32, additional_input, sizeof(additional_input));
+    for (size_t offset = 32; offset < 512; offset += 32)
+        buffered(actual.data() + offset, 32);
+    EXPECT_EQ(actual, expected);
+}
+
+TEST(BufferedCTRDRBGTest, EveryAdditionalInputIsUsed) {
+    using DRBG = CTR_DRBG<OpenSSLAES256, false, ConstantEntropySource<48>>;
+    static constexpr uint8_t first[] = {'f', 'i', 'r', 's', 't'};
+    static constexpr uint8_t second[] = {'s', 'e', 'c', 'o', 'n', 'd'};
+    static constexpr uint8_t third[] = {'t', 'h', 'i', 'r', 'd'};
+    BufferedCTR_DRBG<DRBG, 256> buffered;
+    DRBG plain;
+    std::array<uint8_t, 256> pool1, pool2, pool3;
+    plain(pool1.data(), 256, first, sizeof(first));
+    plain(pool2.data(), 256, second, sizeof(second));
+    plain(pool3.data(), 256, third, sizeof(third));
+    std::array<uint8_t, 32> actual;
+    buffered(actual.data(), 32, first, sizeof(first));
+    EXPECT_TRUE(std::equal(actual.begin(), actual.end(), pool1.begin()));
+    // Второй вход ждёт пополнения, третий вызывает его досрочно.
+    buffered(actual.data(), 32, second, sizeof(second));
+    EXPECT_TRUE(std::equal(actual.begin(), actual.end(), pool1.begin() + 32));
+    buffered(actual.data(), 32, third, sizeof(third));
+    EXPECT_TRUE(std::equal(actual.begin(), actual.end(), pool2.begin()));
+    for (size_t offset = 32; offset < 256; offset += 32) buffered(actual.data(), 32);
+    buffered(actual.data(), 32);
+    EXPECT_TRUE(std::equal(actual.begin(), actual.end(), pool3.begin()));
+}
+
+TEST(BufferedCTRDRBGTest, LargeRequestBypassesPool) {
+    using DRBG = CTR_DRBG<OpenSSLAES256, false, ConstantEntropySource<48>>;
+    BufferedCTR_DRBG<DRBG, 64> buffered;
+    DRBG plain;
+    std::array<uint8_t, 100> expected, actual;
+    plain(expected.data(), 100);
+    buffered(actual.data(), 100);
+    EXPECT_EQ(actual, expected);
+    EXPECT_THROW(buffered(nullptr, 1 << 20), crispex::rbg_query_limit);
+}
+
+TEST(BufferedCTRDRBGTest, ReseedDiscardsPool) {
+    using DRBG = CTR_DRBG<OpenSSLAES256, false, ConstantEntropySource<48>>;
+    BufferedCTR_DRBG<DRBG, 256> buffered;
+    DRBG plain;
+    std::array<uint8_t, 256> pool;
+    std::array<uint8_t, 32> actual;
+    plain(pool.data(), 256);
+    buffered(actual.data(), 32);
+    buffered.reseed();
+    plain.reseed();
+    plain(pool.data(), 256);
+    buffered(actual.data(), 32);
+    EXPECT_TRUE(std::equal(actual.begin(), actual.end(), pool.begin()));
+}
+
+TEST(ShardedCTRDRBGTest, BufferedShards) {
+    ShardedCTR_DRBG<OpenSSLAES256, true, GetrandomSource<48>, 1024> rng;
+    std::set<uint64_t> values;
+    for (size_t i = 0; i < 1000; ++i) values.insert(rng.uint64());
+    EXPECT_EQ(values.size(), 1000);
+}
+
+TEST(EntropySourceTest, Getrandom) {
+    const GetrandomSource<48> source;
+    const GetrandomSource<48, false> plain_source;
+    EXPECT_FALSE(source() == source());
+    EXPECT_FALSE(plain_source() == plain_source());
+    EXPECT_FALSE(source() == plain_source());
+}
+
+TEST(EntropySourceTest, GetrandomOddSize) {
+    const GetrandomSource<13> source;
+    const SecureBuffer<13> first = source();
+    EXPECT_FALSE(first == source());
+}
+
+static std::atomic<size_t> counting_calls = 0;
+static std::atomic<std::thread::id> counting_caller;
+
+class CountingEntropySource : public EntropySource<48> {
+public:
+    SecureBuffer<48> operator()() const override {
+        if (std::this_thread::get_id() == counting_caller.load()) ++counting_calls;
+        return GetrandomSource<48>()();
+    }
+};
+
+TEST(EntropySourceTest, AsyncPrefetch) {
+    counting_caller = std::this_thread::get_id();
+    const AsyncEntropySource<48, CountingEntropySource, 4> source;
+    ASSERT_TRUE(source.waitUntilFull());
+    std::vector<SecureBuffer<48>> values;
+    for (size_t i = 0; i < 4; ++i) values.push_back(source());
+    EXPECT_EQ(counting_calls, 0);
+    for (size_t i = 0; i < 100; ++i) values.push_back(source());
+    for (size_t i = 0; i < values.size(); ++i)
+        for (size_t j = i + 1; j < values.size(); ++j)
+            EXPECT_FALSE(values[i] == values[j]);
+}
+
+TEST(EntropySourceTest, AsyncReseed) {
+    CTR_DRBG<OpenSSLAES256, true, AsyncEntropySource<48>> rng;
+    std::array<uint8_t, 32> first, second;
+    rng(first.data(), 32);
+    rng.reseed();
+    rng(second.data(), 32);
+    EXPECT_NE(first, second);
+}
+
+static std::vector<uint8_t> packBits(const std::string &bits) {
+    std::vector<uint8_t> result((bits.size() + 7) / 8);
+    for (size_t i = 0; i < bits.size(); ++i)
+        if (bits[i] == '1') result[i / 8] |= static_cast<uint8_t>(0x80 >> (i % 8));
+    return result;
+}
+
+TEST(StatisticalTests, NISTExamples) {
+    // Примеры из NIST SP 800-22, разделы 2.1.8 и 2.3.8.
+    const std::string epsilon =
+        "11001001000011111101101010100010001000010110100011"
+        "00001000110100110001001100011001100010100010111000";
+    const std::vector<uint8_t> data = packBits(epsilon);
+    EXPECT_NEAR(statistical_tests::monobit(data.data(), epsilon.size()), 0.109599, 1e-6);
+    EXPECT_NEAR(statistical_tests::runs(data.data(), epsilon.size()), 0.500798, 1e-6);
+    const std::vector<uint8_t> short_data = packBits("1011010101");
+    EXPECT_NEAR(statistical_tests::monobit(short_data.data(), 10), 0.527089, 1e-6);
+    const std::vector<uint8_t> runs_data = packBits("1001101011");
+    EXPECT_NEAR(statistical_tests::runs(runs_data.data(), 10), 0.147232, 1e-6);
+}
+
+TEST(StatisticalTests, RejectsBiasedData) {
+    std::vector<uint8_t> zeros(2500, 0);
+    EXPECT_FALSE(statistical_tests::run(zeros.data(), zeros.size()).passed());
+    std::vector<uint8_t> alternating(2500, 0x55);
+    const auto report = statistical_tests::run(alternating.data(), alternating.size());
+    EXPECT_GE(report.monobit, 0.99);
+    EXPECT_LT(report.runs, 0.01);
+    EXPECT_LT(report.poker, 0.01);
+}
+
+// Энтропия постоянна, поэтому выход и p-значения детерминированы.
+TEST(StatisticalTests, DRBGOutputQuality) {
+    using DRBG = CTR_DRBG<OpenSSLAES256, true, ConstantEntropySource<48>>;
+    std::vector<uint8_t> output(1 << 20);
+    DRBG rng;
+    for (size_t offset = 0; offset < output.size(); offset += 1 << 16)
+        rng(output.data() + offset, 1 << 16);
+    const auto report = statistical_tests::run(output.data(), output.size());
+    EXPECT_TRUE(report.passed(0.001))
+        << "monobit " << report.monobit << " runs " << report.runs << " poker " << report.poker;
+
+    BufferedCTR_DRBG<DRBG, 4096> buffered;
+    for (size_t offset = 0; offset < output.size(); offset += 32)
+        buffered(output.data() + offset, 32);
+    const auto buffered_report = statistical_tests::run(output.data(), output.size());
+    EXPECT_TRUE(buffered_report.passed(0.001))
+        << "monobit " << buffered_report.monobit << " runs " << buffered_report.runs << " poker " << buffered_report.poker;
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "ContextPool.hpp"
+#include "Kuznechik.hpp"
+#include "OMAC.hpp"
+#include "HMAC.hpp"
+#include "NMAC256.hpp"
+#include "SimpleMAC.hpp"
+
+INITIALIZE_EASYLOGGINGPP
+
+template<size_t N>
+static SecureBuffer<N> filled(uint8_t val) {
+    SecureBuffer<N> buf;
+    std::fill(buf.begin(), buf.end(), val);
+    return buf;
+}
+
+template <typename MACType>
+static void checkReuse() {
+    static const SecureBuffer<MACType::KeySize> key1 = filled<MACType::KeySize>(0xAA);
+    static const SecureBuffer<MACType::KeySize> key2 = filled<MACType::KeySize>(0xBB);
+    static const std::vector<uint8_t> message1(100, 0xCC);
+    static const std::vector<uint8_t> message2(37, 0xDD);
+
+    MACType fresh(key2);
+    fresh.update(message2);
+    std::vector<uint8_t> expected(MACType::DigestSize);
+    fresh.digest(expected.data());
+
+    ContextPool<MACType> pool;
+    {
+        auto mac = pool.acquire();
+        mac->initKeySchedule(key1);
+        mac->update(message1.data(), 7);
+    }
+    auto mac = pool.acquire();
+    mac->initKeySchedule(key2);
+    mac->update(message2);
+    std::vector<uint8_t> digest(MACType::DigestSize);
+    mac->digest(digest.data());
+    EXPECT_EQ(digest, expected);
+}
+
+TEST(ContextPoolTest, ReturnsReleasedContext) {
+    ContextPool<Kuznechik> pool;
+    Kuznechik *first;
+    {
+        auto cipher = pool.acquire();
+        first = &*cipher;
+    }
+    EXPECT_EQ(pool.available(), 1);
+    auto cipher = pool.acquire();
+    EXPECT_EQ(&*cipher, first);
+    EXPECT_EQ(pool.available(), 0);
+}
+
+TEST(ContextPoolTest, NestedLeasesAreDistinct) {
+    ContextPool<Kuznechik> pool;
+    auto cipher1 = pool.acquire();
+    auto cipher2 = pool.acquire();
+    EXPECT_NE(&*cipher1, &*cipher2);
+}
+
+TEST(ContextPoolTest, ReleasedContextIsWiped) {
+    ContextPool<Kuznechik> pool;
+    std::array<SecureBuffer<16>, 10> round_keys;
+    {
+        auto cipher = pool.acquire();
+        cipher->initKeySchedule(filled<32>(0xAA));
+        round_keys = cipher->getKeySchedule();
+    }
+    auto cipher = pool.acquire();
+    const std::array<SecureBuffer<16>, 10> released = cipher->getKeySchedule();
+    for (size_t i = 0; i < 10; ++i)
+        EXPECT_FALSE(released[i] == round_keys[i]) << "Не стёрт ключ " << i;
+}
+
+TEST(ContextPoolTest, ReuseOMAC) { checkReuse<OMAC<Kuznechik>>(); }
+TEST(ContextPoolTest, ReuseHMAC) { checkReuse<HMAC<Streebog256, 32>>(); }
+TEST(ContextPoolTest, ReuseNMAC) { checkReuse<NMAC256<32>>(); }
+TEST(ContextPoolTest, ReuseSimpleMAC) { checkReuse<SimpleMAC<32>>(); }
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
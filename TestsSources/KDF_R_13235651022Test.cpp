@@ -14,6 +14,7 @@
 
 #include "SimpleMAC.hpp"
 #include "KDF_R_13235651022.hpp"
+#include "KDF_R_13235651022_Counter.hpp"
 
 INITIALIZE_EASYLOGGINGPP
 
@@ -394,6 +395,94 @@ TEST(KDF_R_13235651022Test, TestDoubleUse) {
     EXPECT_EQ(key1, key2);
 }
 
+TEST(KDF_R_13235651022CounterTest, TestFirstBlockMatchesFeedback) {
+    static const SecureBuffer<32> master_key = filled<32>(0xAA);
+    static const SecureBuffer<32> salt = filled<32>(0xBB);
+    uint8_t IV[16];
+    memset(IV, 0xCC, 16);
+    uint8_t application_info[32];
+    memset(application_info, 0xDD, 32);
+    uint8_t user_info[16];
+    memset(user_info, 0xEE, 16);
+    uint8_t additional_info[16];
+    memset(additional_info, 0xFF, 16);
+    KDF_R_13235651022<SimpleMAC<32>, OMAC<Kuznechik>, 32> kdf(master_key, salt);
+    KDF_R_13235651022_Counter<SimpleMAC<32>, OMAC<Kuznechik>, 32> counter_kdf(master_key, salt);
+    SecureBuffer<64> key1;
+    SecureBuffer<64> key2;
+    kdf.fetch(key1.raw(), 64, IV, application_info, user_info, additional_info);
+    counter_kdf.fetch(key2.raw(), 64, IV, application_info, user_info, additional_info);
+    EXPECT_TRUE(std::equal(key1.begin(), key1.begin() + 16, key2.begin()));
+    EXPECT_FALSE(std::equal(key1.begin() + 16, key1.end(), key2.begin() + 16));
+}
+
+TEST(KDF_R_13235651022CounterTest, TestIndependentBlocks) {
+    static const SecureBuffer<32> master_key = filled<32>(0xAA);
+    static const SecureBuffer<32> salt = filled<32>(0xBB);
+    uint8_t IV[32];
+    memset(IV, 0xCC, 32);
+    uint8_t application_info[32];
+    memset(application_info, 0xDD, 32);
+    uint8_t user_info[16];
+    memset(user_info, 0xEE, 16);
+    uint8_t additional_info[16];
+    memset(additional_info, 0xFF, 16);
+    static constexpr size_t size = 32 * 300 + 7;
+    KDF_R_13235651022_Counter<NMAC256<32>, HMAC<Streebog256, 32>, 32> kdf(master_key, salt);
+    std::vector<uint8_t> key(size);
+    kdf.fetch(key.data(), size, IV, application_info, user_info, additional_info);
+
+    SecureBuffer<32> inner_key;
+    NMAC256<32> inner_mac(salt);
+    inner_mac.update(master_key.raw(), 32);
+    inner_mac.digest(inner_key.raw());
+    HMAC<Streebog256, 32> outer_mac(inner_key);
+    SecureBuffer<32 + 81> format = getFormat(IV, application_info, user_info, additional_info, size);
+    std::vector<uint8_t> expected(size);
+    for (uint64_t counter = 1; (counter - 1) * 32 < size; ++counter) {
+        uint64_t le_counter = htole64(counter);
+        memcpy(format.raw() + 1, &le_counter, 8);
+        uint8_t block[32];
+        outer_mac.update(format.raw(), 32 + 81);
+        outer_mac.digest(block);
+        outer_mac.clear();
+        const size_t offset = (counter - 1) * 32;
+        memcpy(expected.data() + offset, block, std::min<size_t>(32, size - offset));
+    }
+    EXPECT_EQ(key, expected);
+}
+
+TEST(KDF_R_13235651022Test, TestStreamMatchesFetch) {
+    static const SecureBuffer<32> master_key = filled<32>(0xAA);
+    static const SecureBuffer<32> salt = filled<32>(0xBB);
+    uint8_t IV[16];
+    memset(IV, 0xCC, 16);
+    uint8_t application_info[32];
+    memset(application_info, 0xDD, 32);
+    uint8_t user_info[16];
+    memset(user_info, 0xEE, 16);
+    uint8_t additional_info[16];
+    memset(additional_info, 0xFF, 16);
+    static constexpr size_t size = 1000;
+    KDF_R_13235651022<SimpleMAC<32>, OMAC<Kuznechik>, 32> kdf(master_key, salt);
+    std::vector<uint8_t> expected(size);
+    kdf.fetch(expected.data(), size, IV, application_info, user_info, additional_info);
+    std::vector<uint8_t> streamed(size + 10);
+    size_t offset = 0;
+    {
+        auto generator = kdf.stream(size, IV, application_info, user_info, additional_info);
+        for (size_t chunk : std::initializer_list<size_t>{1, 15, 16, 17, 100, 3, 500}) {
+            EXPECT_EQ(generator.next(std::span<uint8_t>(streamed.data() + offset, chunk)), chunk);
+            offset += chunk;
+        }
+        EXPECT_EQ(generator.remaining(), size - offset);
+        EXPECT_EQ(generator.next(std::span<uint8_t>(streamed.data() + offset, size - offset + 10)), size - offset);
+        EXPECT_EQ(generator.remaining(), 0);
+    }
+    streamed.resize(size);
+    EXPECT_EQ(streamed, expected);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -92,7 +92,7 @@ TEST(KuznechikTest, TestKeySchedule) {
         { 0x72, 0xe9, 0xdd, 0x74, 0x16, 0xbc, 0xf4, 0x5b, 0x75, 0x5d, 0xba, 0xa8, 0x8e, 0x4a, 0x40, 0x43 }
     };
     Kuznechik ctx(key);
-    const SecureBuffer<16> *result_round_keys = ctx.getKeySchedule();
+    const std::array<SecureBuffer<16>, 10> result_round_keys = ctx.getKeySchedule();
     for (uint8_t i = 0; i < 10; ++i)
         EXPECT_EQ(round_keys[i], result_round_keys[i]) << "Не совпал ключ " << i;
 }
@@ -123,6 +123,53 @@ TEST(KuznechikTest, TestDecrtyption) {
     EXPECT_EQ(ctx.decrypt(encrypted_text), plain_text);
 }
 
+TEST(KuznechikTest, TestEncryptBlocks) {
+    static const SecureBuffer key = {
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10, 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef
+    };
+    static const uint8_t plain_text[16] =
+        { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+    static const uint8_t encrypted_text[16] =
+        { 0x7f, 0x67, 0x9d, 0x90, 0xbe, 0xbc, 0x24, 0x30, 0x5a, 0x46, 0x8d, 0x42, 0xb9, 0xd4, 0xed, 0xcd };
+    uint8_t blocks[3 * 16];
+    for (size_t i = 0; i < 3; ++i) memcpy(blocks + i * 16, plain_text, 16);
+    Kuznechik ctx(key);
+    ctx.encryptBlocks(blocks, 3);
+    for (size_t i = 0; i < 3; ++i) EXPECT_EQ(memcmp(blocks + i * 16, encrypted_text, 16), 0);
+}
+
+TEST(Block128Test, Xor) {
+    static const uint8_t x[16] =
+        { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+    static const uint8_t y[16] =
+        { 0x0f, 0x0f, 0x0f, 0x0f, 0xf0, 0xf0, 0xf0, 0xf0, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+    Block128 a = Block128::load(x);
+    a ^= Block128::load(y);
+    for (size_t i = 0; i < 16; ++i) EXPECT_EQ(a[i], x[i] ^ y[i]);
+    a.xorFrom(y);
+    uint8_t stored[16];
+    a.store(stored);
+    EXPECT_EQ(memcmp(stored, x, 16), 0);
+}
+
+TEST(KuznechikTest, TestEncryptBlock128) {
+    static const SecureBuffer key = {
+        0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+        0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10, 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef
+    };
+    static const uint8_t plain_text[16] =
+        { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x00, 0xff, 0xee, 0xdd, 0xcc, 0xbb, 0xaa, 0x99, 0x88 };
+    static const uint8_t encrypted_text[16] =
+        { 0x7f, 0x67, 0x9d, 0x90, 0xbe, 0xbc, 0x24, 0x30, 0x5a, 0x46, 0x8d, 0x42, 0xb9, 0xd4, 0xed, 0xcd };
+    Kuznechik ctx(key);
+    Block128 block = Block128::load(plain_text);
+    ctx.encryptBlock(block);
+    EXPECT_EQ(memcmp(block.bytes, encrypted_text, 16), 0);
+    ctx.decryptBlock(block);
+    EXPECT_EQ(memcmp(block.bytes, plain_text, 16), 0);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
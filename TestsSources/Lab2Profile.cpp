@@ -0,0 +1,202 @@
+/*  Профилирование KDF_R_13235651022 по фазам для всех 12 сочетаний
+    InnerMAC x OuterMAC из CryptographicSuites.hpp.
+    Для каждого размера выхода (от 32 Б до 1 МиБ) измеряются:
+      init   - выработка промежуточного ключа (InnerMAC) и ключевое расписание OuterMAC;
+      format - построение и обновление формата;
+      mac    - вычисление OuterMAC по всем блокам;
+      total  - init + fetch целиком.
+    Фазы замеряются внутри KDF_R_13235651022 (kdf_phase_times, собирается
+    с KDF_PROFILE) на тех же выработках, что и total.
+    Дополнительно на одну выработку подсчитываются вызовы mlock/munlock
+    (через -Wl,--wrap), выделения памяти в куче и вызовы логирования.
+*/
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <new>
+
+#include "NMAC256.hpp"
+#include "HMAC.hpp"
+#include "OMAC.hpp"
+#include "Kuznechik.hpp"
+#include "SimpleMAC.hpp"
+#include "KDF_R_13235651022.hpp"
+#include "Utils.hpp"
+
+#ifndef KDF_PROFILE
+#error "Lab2Profile собирается с KDF_PROFILE"
+#endif
+
+INITIALIZE_EASYLOGGINGPP
+
+static std::atomic<size_t> mlock_calls = 0;
+static std::atomic<size_t> munlock_calls = 0;
+static std::atomic<size_t> allocations = 0;
+static std::atomic<size_t> log_calls = 0;
+
+extern "C" {
+    int __real_mlock(const void *addr, size_t len);
+    int __real_munlock(const void *addr, size_t len);
+    int __wrap_mlock(const void *addr, size_t len) { ++mlock_calls; return __real_mlock(addr, len); }
+    int __wrap_munlock(const void *addr, size_t len) { ++munlock_calls; return __real_munlock(addr, len); }
+}
+
+// Замещающие operator new/delete сами построены на malloc/free,
+// поэтому предупреждение о несоответствии пар здесь ложное.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void *operator new(size_t size) {
+    ++allocations;
+    if (void *ptr = malloc(size)) return ptr;
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, std::align_val_t alignment) {
+    ++allocations;
+    // aligned_alloc требует размер, кратный выравниванию.
+    const size_t align = static_cast<size_t>(alignment);
+    if (void *ptr = aligned_alloc(align, (size + align - 1) / align * align)) return ptr;
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept { free(ptr); }
+#pragma GCC diagnostic pop
+
+class LogCounter : public el::LogDispatchCallback {
+protected:
+    void handle(const el::LogDispatchData *) override { ++log_calls; }
+};
+
+struct Counters {
+    size_t mlock;
+    size_t munlock;
+    size_t allocations;
+    size_t logs;
+    static Counters now() noexcept { return {mlock_calls, munlock_calls, ::allocations, log_calls}; }
+};
+
+struct Phases {
+    double init_us = 0;
+    double format_us = 0;
+    double mac_us = 0;
+    double total_us = 0;
+    Counters per_derivation = {};
+};
+
+using Clock = std::chrono::steady_clock;
+
+static inline double since(const Clock::time_point start) noexcept {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+static inline double microseconds(const std::atomic<int64_t> &phase_ns) noexcept {
+    return static_cast<double>(phase_ns.load(std::memory_order_relaxed)) / 1000.0;
+}
+
+template<size_t N>
+static SecureBuffer<N> filled(uint8_t val) {
+    SecureBuffer<N> buf;
+    std::fill(buf.begin(), buf.end(), val);
+    return buf;
+}
+
+template <IsMAC InnerMAC, IsMAC OuterMAC>
+static Phases profile(const size_t size, const size_t repetitions) {
+    static const SecureBuffer<32> master_key = filled<32>(0xAA);
+    static const SecureBuffer<InnerMAC::KeySize> salt = filled<InnerMAC::KeySize>(0xBB);
+    uint8_t IV[OuterMAC::DigestSize];
+    memset(IV, 0xCC, OuterMAC::DigestSize);
+    uint8_t application_info[32];
+    memset(application_info, 0xDD, 32);
+    uint8_t user_info[16];
+    memset(user_info, 0xEE, 16);
+    uint8_t additional_info[16];
+    memset(additional_info, 0xFF, 16);
+    std::vector<uint8_t> key(size);
+    Phases phases;
+
+    kdf_phase_times.init_ns = 0;
+    kdf_phase_times.format_ns = 0;
+    kdf_phase_times.mac_ns = 0;
+    const Counters before = Counters::now();
+    const auto start = Clock::now();
+    for (size_t r = 0; r < repetitions; ++r) {
+        KDF_R_13235651022<InnerMAC, OuterMAC, 32> kdf(master_key, salt);
+        kdf.fetch(key.data(), size, IV, application_info, user_info, additional_info);
+    }
+    phases.total_us = since(start);
+    const Counters after = Counters::now();
+    phases.init_us = microseconds(kdf_phase_times.init_ns);
+    phases.format_us = microseconds(kdf_phase_times.format_ns);
+    phases.mac_us = microseconds(kdf_phase_times.mac_ns);
+
+    const double n = static_cast<double>(repetitions);
+    phases.init_us /= n;
+    phases.format_us /= n;
+    phases.mac_us /= n;
+    phases.total_us /= n;
+    phases.per_derivation = {
+        (after.mlock - before.mlock) / repetitions,
+        (after.munlock - before.munlock) / repetitions,
+        (after.allocations - before.allocations) / repetitions,
+        (after.logs - before.logs) / repetitions
+    };
+    return phases;
+}
+
+template <IsMAC InnerMAC, IsMAC OuterMAC>
+static void sweep(const std::string &name) {
+    for (size_t size = 32; size <= (static_cast<size_t>(1) << 20); size <<= 1) {
+        const size_t repetitions = std::clamp<size_t>((static_cast<size_t>(1) << 16) / size, 1, 1000);
+        const Phases p = profile<InnerMAC, OuterMAC>(size, repetitions);
+        std::cout << std::left << std::setw(18) << name << std::right
+                  << std::setw(9) << size
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << p.init_us
+                  << std::setw(12) << p.format_us
+                  << std::setw(12) << p.mac_us
+                  << std::setw(12) << p.total_us
+                  << std::setw(8) << p.per_derivation.mlock
+                  << std::setw(8) << p.per_derivation.munlock
+                  << std::setw(8) << p.per_derivation.allocations
+                  << std::setw(6) << p.per_derivation.logs
+                  << std::endl;
+    }
+}
+
+int main() {
+    confLog();
+    el::Helpers::installLogDispatchCallback<LogCounter>("LogCounter");
+    std::cout << std::left << std::setw(18) << "Inner_Outer" << std::right
+              << std::setw(9) << "bytes"
+              << std::setw(12) << "init, us"
+              << std::setw(12) << "format, us"
+              << std::setw(12) << "mac, us"
+              << std::setw(12) << "total, us"
+              << std::setw(8) << "mlock"
+              << std::setw(8) << "munlock"
+              << std::setw(8) << "allocs"
+              << std::setw(6) << "logs"
+              << std::endl;
+    sweep<NMAC256<32>, NMAC256<32>>("NMAC_NMAC");
+    sweep<NMAC256<32>, HMAC<Streebog256, 32>>("NMAC_HMAC256");
+    sweep<NMAC256<32>, HMAC<Streebog512, 32>>("NMAC_HMAC512");
+    sweep<NMAC256<32>, OMAC<Kuznechik>>("NMAC_CMAC");
+    sweep<HMAC<Streebog512, 32>, NMAC256<32>>("HMAC_NMAC");
+    sweep<HMAC<Streebog512, 32>, HMAC<Streebog256, 32>>("HMAC_HMAC256");
+    sweep<HMAC<Streebog512, 32>, HMAC<Streebog512, 32>>("HMAC_HMAC512");
+    sweep<HMAC<Streebog512, 32>, OMAC<Kuznechik>>("HMAC_CMAC");
+    sweep<SimpleMAC<32>, NMAC256<32>>("Simple_NMAC");
+    sweep<SimpleMAC<32>, HMAC<Streebog256, 32>>("Simple_HMAC256");
+    sweep<SimpleMAC<32>, HMAC<Streebog512, 32>>("Simple_HMAC512");
+    sweep<SimpleMAC<32>, OMAC<Kuznechik>>("Simple_CMAC");
+    return 0;
+}
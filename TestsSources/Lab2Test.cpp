@@ -13,6 +13,7 @@
 
 #include "SimpleMAC.hpp"
 #include "KDF_R_13235651022.hpp"
+#include "KDF_R_13235651022_Counter.hpp"
 
 #include "Utils.hpp"
 
@@ -486,4 +487,42 @@ void KDF_R_13235651022_OpenSSLFirstSimpleSecondCMAC(benchmark::State& state) {
 }
 BENCHMARK(KDF_R_13235651022_OpenSSLFirstSimpleSecondCMAC);
 
+void KDF_R_13235651022_CounterFirstNMACSecondNMAC(benchmark::State& state) {
+    static const SecureBuffer<128> master_key = filled<128>(0xAA);
+    static const SecureBuffer<128> salt = filled<128>(0xBB);
+    uint8_t IV[32];
+    memset(IV, 0xCC, 32);
+    uint8_t application_info[32];
+    memset(application_info, 0xDD, 32);
+    uint8_t user_info[16];
+    memset(user_info, 0xEE, 16);
+    uint8_t additional_info[16];
+    memset(additional_info, 0xFF, 16);
+    KDF_R_13235651022_Counter<NMAC256<128>, NMAC256<32>, 128> kdf(master_key, salt);
+    std::vector<uint8_t> keys(32000000);
+    for (auto _ : state)
+        kdf.fetch(keys.data(), keys.size(), IV, application_info, user_info, additional_info);
+    state.SetBytesProcessed(state.iterations() * 32000000);
+}
+BENCHMARK(KDF_R_13235651022_CounterFirstNMACSecondNMAC);
+
+void KDF_R_13235651022_CounterFirstSimpleSecondCMAC(benchmark::State& state) {
+    static const SecureBuffer<32> master_key = filled<32>(0xAA);
+    static const SecureBuffer<32> salt = filled<32>(0xBB);
+    uint8_t IV[16];
+    memset(IV, 0xCC, 16);
+    uint8_t application_info[32];
+    memset(application_info, 0xDD, 32);
+    uint8_t user_info[16];
+    memset(user_info, 0xEE, 16);
+    uint8_t additional_info[16];
+    memset(additional_info, 0xFF, 16);
+    KDF_R_13235651022_Counter<SimpleMAC<32>, OMAC<Kuznechik>, 32> kdf(master_key, salt);
+    std::vector<uint8_t> keys(32000000);
+    for (auto _ : state)
+        kdf.fetch(keys.data(), keys.size(), IV, application_info, user_info, additional_info);
+    state.SetBytesProcessed(state.iterations() * 32000000);
+}
+BENCHMARK(KDF_R_13235651022_CounterFirstSimpleSecondCMAC);
+
 BENCHMARK_MAIN();
\ No newline at end of file
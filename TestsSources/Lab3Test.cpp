@@ -1,6 +1,9 @@
 #include <benchmark/benchmark.h>
 #include "Kuznechik.hpp"
 #include "CTR_DRBG.hpp"
+#include "ShardedCTR_DRBG.hpp"
+#include "AsyncEntropySource.hpp"
+#include "StatisticalTests.hpp"
 #include "Utils.hpp"
 
 INITIALIZE_EASYLOGGINGPP
@@ -173,4 +176,59 @@ static void Gen1000Keys(benchmark::State& state) {
 }
 BENCHMARK(Gen1000Keys);
 
+// Пропускная способность при разных размерах запроса и числе потоков.
+// Каждый поток бенчмарка получает собственный шард.
+static void DRBG_RequestSize(benchmark::State& state) {
+    static ShardedCTR_DRBG<Kuznechik, true> rng;
+    const size_t size = static_cast<size_t>(state.range(0));
+    std::vector<uint8_t> buffer(size);
+    for (auto _ : state)
+        rng(buffer.data(), size);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK(DRBG_RequestSize)->RangeMultiplier(8)->Range(16, 1 << 16)->ThreadRange(1, 8);
+
+static void DRBG_BufferedRequestSize(benchmark::State& state) {
+    static ShardedCTR_DRBG<Kuznechik, true, GetrandomSource<48>, 4096> rng;
+    const size_t size = static_cast<size_t>(state.range(0));
+    std::vector<uint8_t> buffer(size);
+    for (auto _ : state)
+        rng(buffer.data(), size);
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK(DRBG_BufferedRequestSize)->RangeMultiplier(8)->Range(16, 4096)->ThreadRange(1, 8);
+
+// Задержка пересеивания для каждого источника энтропии.
+template <typename EntropySourceType>
+static void DRBG_Reseed(benchmark::State& state) {
+    CTR_DRBG<Kuznechik, false, EntropySourceType> rng;
+    for (auto _ : state)
+        rng.reseed();
+}
+BENCHMARK_TEMPLATE(DRBG_Reseed, Urandom<48>);
+BENCHMARK_TEMPLATE(DRBG_Reseed, GetrandomSource<48>);
+BENCHMARK_TEMPLATE(DRBG_Reseed, GetrandomSource<48, false>);
+BENCHMARK_TEMPLATE(DRBG_Reseed, AsyncEntropySource<48>);
+
+// Контроль качества выхода: p-значения тестов выводятся как счётчики,
+// при провале бенчмарк завершается с ошибкой.
+static void DRBG_Quality(benchmark::State& state) {
+    static constexpr size_t size = static_cast<size_t>(1) << 20;
+    std::vector<uint8_t> output(size);
+    statistical_tests::Report report{};
+    for (auto _ : state) {
+        CTR_DRBG<Kuznechik, true> rng;
+        for (size_t offset = 0; offset < size; offset += BUFFER_SIZE)
+            rng(output.data() + offset, BUFFER_SIZE);
+        report = statistical_tests::run(output.data(), size);
+    }
+    state.counters["monobit"] = report.monobit;
+    state.counters["runs"] = report.runs;
+    state.counters["poker"] = report.poker;
+    if (!report.passed(0.001))
+        state.SkipWithError("Выход ПДСЧ не прошёл статистические тесты");
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK(DRBG_Quality);
+
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
+#include <set>
+#include <thread>
+#include <vector>
 #include "SecureBuffer.hpp"
+#include "SecureVector.hpp"
 
 INITIALIZE_EASYLOGGINGPP
 
@@ -82,6 +86,18 @@ TEST(SecureBufferTest, AdditionOperator) {
     EXPECT_EQ(buffer1[1], uint8_t(0b01011010));
 }
 
+TEST(SecureBufferTest, AdditionOperatorOddSize) {
+    SecureBuffer<11> buffer1;
+    SecureBuffer<11> buffer2;
+    for (uint8_t i = 0; i < 11; ++i) {
+        buffer1[i] = static_cast<uint8_t>(i * 17);
+        buffer2[i] = static_cast<uint8_t>(0xFF - i);
+    }
+    buffer1 += buffer2;
+    for (uint8_t i = 0; i < 11; ++i)
+        EXPECT_EQ(buffer1[i], static_cast<uint8_t>((i * 17) ^ (0xFF - i)));
+}
+
 TEST(SecureBufferTest, AssignmentToSelf) {
     SecureBuffer original = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
     original = original;
@@ -89,7 +105,6 @@ TEST(SecureBufferTest, AssignmentToSelf) {
         EXPECT_EQ(original[i], i + 1);
 }
 
-#ifndef SECUREBUFFER_BIG_ENDIAN_COUNTER
 TEST(SecureBufferTest, Add) {
     SecureBuffer<4> buf; buf.zero();
     buf.add(1);
@@ -99,17 +114,37 @@ TEST(SecureBufferTest, Add) {
     buf.add(0x10000);
     EXPECT_EQ(buf, SecureBuffer<4>({0,1,1,0}));
 }
-#else
-TEST(SecureBufferTest, Add) {
+
+TEST(SecureBufferTest, AddBigEndian) {
     SecureBuffer<4> buf; buf.zero();
-    buf.add(1);
+    buf.add<std::endian::big>(1);
     EXPECT_EQ(buf, SecureBuffer<4>({0,0,0,1}));
-    buf.add(255);
+    buf.add<std::endian::big>(255);
     EXPECT_EQ(buf, SecureBuffer<4>({0,0,1,0}));
-    buf.add(0x10000);
+    buf.add<std::endian::big>(0x10000);
     EXPECT_EQ(buf, SecureBuffer<4>({0,1,1,0}));
 }
-#endif
+
+TEST(SecureBufferTest, AddCarriesAcrossWords) {
+    SecureBuffer<12> little = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x00};
+    little.add(1);
+    EXPECT_EQ(little, SecureBuffer<12>({0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01}));
+    SecureBuffer<12> big = {0x00, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    big.add<std::endian::big>(2);
+    EXPECT_EQ(big, SecureBuffer<12>({0x01, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01}));
+    SecureBuffer<16> wrap; std::fill(wrap.begin(), wrap.end(), 0xff);
+    wrap.add<std::endian::big>(1);
+    SecureBuffer<16> zero; zero.zero();
+    EXPECT_EQ(wrap, zero);
+}
+
+TEST(SecureBufferTest, LeftShiftOperator_AcrossWords) {
+    SecureBuffer<16> buffer = {0x01, 0, 0, 0, 0, 0, 0, 0x80, 0xC0, 0, 0, 0, 0, 0, 0, 0x81};
+    buffer <<= 1;
+    EXPECT_EQ(buffer, SecureBuffer<16>({0x02, 0, 0, 0, 0, 0, 0x01, 0x01, 0x80, 0, 0, 0, 0, 0, 0x01, 0x02}));
+    buffer <<= 12;
+    EXPECT_EQ(buffer, SecureBuffer<16>({0, 0, 0, 0, 0, 0x10, 0x18, 0, 0, 0, 0, 0, 0, 0x10, 0x20, 0}));
+}
 
 
 TEST(SecureBufferIteratorTest, BasicDereferenceAndIncrement) {
@@ -182,6 +217,303 @@ TEST(SecureBufferIteratorTest, FullIteration) {
     }
 }
 
+TEST(SecureBufferTest, MoveConstructorStealsStorage) {
+    SecureBuffer original = {1, 2, 3, 4};
+    const uint8_t *raw = original.raw();
+    SecureBuffer moved(std::move(original));
+    EXPECT_EQ(moved.raw(), raw);
+    EXPECT_EQ(moved, SecureBuffer({1, 2, 3, 4}));
+    original = moved;
+    EXPECT_EQ(original, moved);
+    EXPECT_NE(original.raw(), moved.raw());
+}
+
+TEST(SecureBufferTest, MovedFromBufferIsUsable) {
+    SecureBuffer<16> original;
+    std::fill(original.begin(), original.end(), 0xAB);
+    SecureBuffer<16> moved(std::move(original));
+    // Источник получает новую обнулённую память при первом обращении.
+    EXPECT_EQ(std::count(original.begin(), original.end(), 0), 16);
+    EXPECT_NE(original.raw(), moved.raw());
+    original.add<std::endian::big>(1);
+    EXPECT_EQ(original[15], 1);
+    const SecureBuffer<16> copy(original);
+    EXPECT_EQ(copy, original);
+    SecureBuffer<16> other(std::move(original));
+    original <<= 8;
+    original += other;
+    EXPECT_EQ(original, other);
+    EXPECT_EQ(moved[0], 0xAB);
+}
+
+TEST(SecureBufferTest, MoveAssignmentSwapsStorage) {
+    SecureBuffer a = {1, 2, 3, 4};
+    SecureBuffer b = {5, 6, 7, 8};
+    const uint8_t *raw_a = a.raw();
+    const uint8_t *raw_b = b.raw();
+    a = std::move(b);
+    EXPECT_EQ(a.raw(), raw_b);
+    EXPECT_EQ(b.raw(), raw_a);
+    EXPECT_EQ(a, SecureBuffer({5, 6, 7, 8}));
+}
+
+TEST(LockedArenaTest, ReusesFreedCells) {
+    void *first = LockedArena::allocate(48);
+    LockedArena::deallocate(first, 48);
+    void *second = LockedArena::allocate(64);
+    EXPECT_EQ(first, second);
+    LockedArena::deallocate(second, 64);
+}
+
+TEST(LockedArenaTest, CellsAreAlignedToClassSize) {
+    for (size_t size = LockedArena::MinClass; size <= LockedArena::MaxClass; size <<= 1) {
+        void *ptr = LockedArena::allocate(size);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % size, 0u);
+        memset(ptr, 0xAB, size);
+        LockedArena::deallocate(ptr, size);
+    }
+    void *large = LockedArena::allocate(3 * LockedArena::MaxClass);
+    memset(large, 0xAB, 3 * LockedArena::MaxClass);
+    LockedArena::deallocate(large, 3 * LockedArena::MaxClass);
+}
+
+TEST(LockedArenaTest, BuffersFromCacheLineUpOwnTheirLines) {
+    EXPECT_LT(LockedMemoryBudget::currentNode(), LockedMemoryBudget::MaxNodes);
+    for (size_t size : {size_t(33), size_t(64), size_t(160), size_t(1000), 2 * LockedArena::MaxClass}) {
+        EXPECT_EQ(LockedArena::alignment(size) % LockedArena::CacheLine, 0u) << size;
+        void *ptr = LockedArena::allocate(size);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % LockedArena::alignment(size), 0u) << size;
+        LockedArena::deallocate(ptr, size);
+    }
+    SecureBuffer<160> key_schedule;
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(key_schedule.raw()) % LockedArena::CacheLine, 0u);
+}
+
+TEST(LockedArenaTest, BuffersFreedInOtherThread) {
+    std::vector<SecureBuffer<32> *> buffers;
+    std::thread producer([&] {
+        for (size_t i = 0; i < 1000; ++i) {
+            buffers.push_back(new SecureBuffer<32>());
+            buffers.back()->zero();
+            (*buffers.back())[0] = static_cast<uint8_t>(i);
+        }
+    });
+    producer.join();
+    std::set<const uint8_t *> addresses;
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        EXPECT_EQ((*buffers[i])[0], static_cast<uint8_t>(i));
+        addresses.insert(buffers[i]->raw());
+    }
+    EXPECT_EQ(addresses.size(), buffers.size());
+    for (auto *buffer : buffers) delete buffer;
+}
+
+TEST(SecureWipeTest, ZeroesMemory) {
+    uint8_t data[37];
+    memset(data, 0xAB, sizeof(data));
+    secureWipe(data, sizeof(data));
+#ifdef SECUREBUFFER_RANDOM_WIPE
+    // Случайный байт совпадает с шаблоном с вероятностью 1/256.
+    EXPECT_LT(std::count(data, data + sizeof(data), 0xAB), 8);
+#else
+    for (const uint8_t byte : data) EXPECT_EQ(byte, 0);
+#endif
+}
+
+TEST(SecureWipeTest, StreamDoesNotRepeat) {
+    WipeStream stream;
+    std::set<uint64_t> words;
+    for (size_t i = 0; i < 100; ++i) words.insert(stream.next());
+    EXPECT_EQ(words.size(), 100u);
+}
+
+TEST(SecureWipeTest, ZeroesAfterStreamDestroyed) {
+    static uint8_t data[37];
+    static bool stream_destroyed = false;
+    struct LateWipe {
+        ~LateWipe() {
+            stream_destroyed = WipeStream::local() == nullptr;
+            memset(data, 0xAB, sizeof(data));
+            secureWipe(data, sizeof(data));
+        }
+    };
+    std::thread([] {
+        // Создан раньше потока, поэтому разрушается после него.
+        static thread_local LateWipe late;
+        (void)late;
+        WipeStream::local()->next();
+    }).join();
+    EXPECT_TRUE(stream_destroyed);
+    for (const uint8_t byte : data) EXPECT_EQ(byte, 0);
+}
+
+TEST(SecureVectorTest, GrowsAndKeepsContents) {
+    SecureVector vec = {1, 2, 3};
+    for (uint8_t i = 4; i <= 100; ++i) vec.push_back(i);
+    ASSERT_EQ(vec.size(), 100u);
+    for (size_t i = 0; i < vec.size(); ++i) EXPECT_EQ(vec[i], i + 1);
+    const std::vector<uint8_t> expected(vec.begin(), vec.end());
+    EXPECT_EQ(vec, expected);
+}
+
+TEST(SecureVectorTest, ShrinkWipesTail) {
+    SecureVector vec(64);
+    std::fill(vec.begin(), vec.end(), 0xAB);
+    const uint8_t *raw = vec.data();
+    vec.resize(16);
+    EXPECT_EQ(vec.data(), raw);
+#ifdef SECUREBUFFER_RANDOM_WIPE
+    EXPECT_LT(std::count(raw + 16, raw + 64, 0xAB), 8);
+#else
+    for (size_t i = 16; i < 64; ++i) EXPECT_EQ(raw[i], 0);
+#endif
+    for (size_t i = 0; i < 16; ++i) EXPECT_EQ(raw[i], 0xAB);
+}
+
+TEST(SecureVectorTest, SizedAndGrownBytesAreZero) {
+    SecureVector vec(32);
+    for (const uint8_t byte : vec) EXPECT_EQ(byte, 0);
+    std::fill(vec.begin(), vec.end(), 0xAB);
+    vec.resize(8);
+    vec.resize(32);
+    for (size_t i = 8; i < 32; ++i) EXPECT_EQ(vec[i], 0);
+    EXPECT_EQ(SecureVector::uninitialized(100).size(), 100u);
+}
+
+TEST(SecureVectorTest, MoveTransfersOwnership) {
+    SecureVector original(3000);
+    const uint8_t *raw = original.data();
+    SecureVector moved(std::move(original));
+    EXPECT_EQ(moved.data(), raw);
+    EXPECT_EQ(moved.size(), 3000u);
+    SecureVector assigned;
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.data(), raw);
+}
+
+TEST(LockedMemoryBudgetTest, CountsLockedMappings) {
+    static constexpr size_t size = 4 * LockedArena::PageSize;
+    const LockedMemoryBudget::Stats before = LockedMemoryBudget::stats();
+    void *ptr = LockedArena::allocate(size);
+    const LockedMemoryBudget::Stats during = LockedMemoryBudget::stats();
+    EXPECT_EQ(during.locked, before.locked + size);
+    EXPECT_GE(during.high_water, during.locked);
+    LockedArena::deallocate(ptr, size);
+    EXPECT_EQ(LockedMemoryBudget::stats().locked, before.locked);
+}
+
+TEST(LockedMemoryBudgetTest, AppliesPolicyWhenExhausted) {
+    static constexpr size_t size = 4 * LockedArena::PageSize;
+    LockedMemoryBudget::Settings settings;
+    settings.limit = LockedMemoryBudget::stats().locked + 1;
+    settings.wait_timeout = std::chrono::milliseconds(10);
+
+    settings.policy = LockedMemoryPolicy::Fail;
+    LockedMemoryBudget::configure(settings);
+    EXPECT_THROW(LockedArena::allocate(size), std::bad_alloc);
+
+    settings.policy = LockedMemoryPolicy::Wait;
+    LockedMemoryBudget::configure(settings);
+    EXPECT_THROW(LockedArena::allocate(size), std::bad_alloc);
+
+    settings.policy = LockedMemoryPolicy::Unlocked;
+    LockedMemoryBudget::configure(settings);
+    const LockedMemoryBudget::Stats before = LockedMemoryBudget::stats();
+    void *ptr = LockedArena::allocate(size);
+    memset(ptr, 0xAB, size);
+    EXPECT_EQ(LockedMemoryBudget::stats().unlocked, before.unlocked + size);
+    EXPECT_EQ(LockedMemoryBudget::stats().fallbacks, before.fallbacks + 1);
+    EXPECT_EQ(LockedMemoryBudget::stats().locked, before.locked);
+    LockedArena::deallocate(ptr, size);
+    EXPECT_EQ(LockedMemoryBudget::stats().unlocked, before.unlocked);
+
+    LockedMemoryBudget::configure({});
+}
+
+TEST(LockedMemoryBudgetTest, WaitResumesAfterRelease) {
+    static constexpr size_t size = 4 * LockedArena::PageSize;
+    void *held = LockedArena::allocate(size);
+    LockedMemoryBudget::Settings settings;
+    settings.policy = LockedMemoryPolicy::Wait;
+    settings.wait_timeout = std::chrono::seconds(10);
+    settings.limit = LockedMemoryBudget::stats().locked;
+    LockedMemoryBudget::configure(settings);
+    std::thread releaser([held] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        LockedArena::deallocate(held, size);
+    });
+    void *ptr = LockedArena::allocate(size);
+    releaser.join();
+    EXPECT_NE(ptr, nullptr);
+    LockedArena::deallocate(ptr, size);
+    LockedMemoryBudget::configure({});
+}
+
+TEST(LockedMemoryBudgetTest, ArenaChunksDoNotWait) {
+    LockedMemoryBudget::Settings settings;
+    settings.policy = LockedMemoryPolicy::Wait;
+    settings.wait_timeout = std::chrono::seconds(10);
+    settings.limit = LockedMemoryBudget::stats().locked + 1;
+    LockedMemoryBudget::configure(settings);
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(LockedMemoryBudget::map(LockedArena::ChunkSize, LockedMemoryBudget::AnyNode, false), std::bad_alloc);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+    settings.huge_page_threshold = LockedArena::ChunkSize;
+    LockedMemoryBudget::configure(settings);
+    const auto huge_start = std::chrono::steady_clock::now();
+    EXPECT_THROW(LockedMemoryBudget::map(LockedArena::ChunkSize, LockedMemoryBudget::AnyNode, false), std::bad_alloc);
+    EXPECT_LT(std::chrono::steady_clock::now() - huge_start, std::chrono::seconds(1));
+    LockedMemoryBudget::configure({});
+}
+
+TEST(LockedMemoryBudgetTest, MapsLargeBuffersOnHugePages) {
+    static constexpr size_t huge = LockedMemoryBudget::HugePageSize;
+    LockedMemoryBudget::Settings settings;
+    settings.policy = LockedMemoryPolicy::Unlocked;
+    settings.huge_page_threshold = huge;
+    LockedMemoryBudget::configure(settings);
+    const LockedMemoryBudget::Stats before = LockedMemoryBudget::stats();
+    {
+        SecureVector small(huge - 1);
+        EXPECT_EQ(LockedMemoryBudget::stats().huge, before.huge);
+        SecureVector large(huge + 1);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(large.data()) % huge, 0u);
+        EXPECT_EQ(LockedMemoryBudget::stats().huge, before.huge + 2 * huge);
+        memset(large.data(), 0xAB, large.size());
+    }
+    const LockedMemoryBudget::Stats after = LockedMemoryBudget::stats();
+    EXPECT_EQ(after.huge, before.huge);
+    EXPECT_EQ(after.locked, before.locked);
+    EXPECT_EQ(after.unlocked, before.unlocked);
+    LockedMemoryBudget::configure({});
+}
+
+TEST(SecureBufferStatsTest, CountsAllocationsLocksAndWipes) {
+    const SecureBufferStats::Snapshot before = SecureBufferStats::snapshot();
+    {
+        SecureBuffer<32> small;
+        SecureVector large(LockedArena::MaxClass + 1);
+        std::thread([] { SecureBuffer<16> other; }).join();
+    }
+    const SecureBufferStats::Snapshot after = SecureBufferStats::snapshot();
+    if (!SecureBufferStats::enabled) {
+        EXPECT_EQ(after.wipe_calls, 0u);
+        EXPECT_EQ(after.peak_live_bytes, 0u);
+        return;
+    }
+    EXPECT_EQ(after.allocations[0], before.allocations[0] + 1);
+    EXPECT_EQ(after.allocations[1], before.allocations[1] + 1);
+    EXPECT_EQ(after.allocations[SecureBufferStats::NumClasses - 1],
+              before.allocations[SecureBufferStats::NumClasses - 1] + 1);
+    EXPECT_EQ(after.lock_calls, before.lock_calls + 1);
+    EXPECT_EQ(after.unlock_calls, before.unlock_calls + 1);
+    EXPECT_GE(after.wipe_calls, before.wipe_calls + 3);
+    EXPECT_GE(after.wiped_bytes, before.wiped_bytes + 16 + 32 + LockedArena::MaxClass + 1);
+    EXPECT_EQ(after.live_bytes, before.live_bytes);
+    EXPECT_GE(after.peak_live_bytes, before.live_bytes + 32 + LockedArena::MaxClass + 1);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -60,6 +60,28 @@ TEST(SimpleMACTest, Clear) {
     EXPECT_EQ(digest, expected_digest);
 }
 
+TEST(SimpleMACTest, SplitUpdates) {
+    SecureBuffer<32> key;
+    std::fill(key.begin(), key.end(), 0xAA);
+    std::array<uint8_t, 1000> text;
+    for (size_t i = 0; i < text.size(); ++i)
+        text[i] = static_cast<uint8_t>(i * 7 + 3);
+    std::array<uint8_t, 32> expected_digest;
+    std::fill(expected_digest.begin(), expected_digest.end(), 0xAA);
+    for (size_t i = 0; i < text.size(); ++i)
+        expected_digest[i % 32] ^= text[i];
+
+    SimpleMAC mac(key);
+    mac.update(text.data(), 5);
+    mac.update(text.data() + 5, 27);
+    mac.update(text.data() + 32, 100);
+    mac.update(text.data() + 132, 868);
+    std::array<uint8_t, 32> digest;
+    mac.digest(digest.data());
+
+    EXPECT_EQ(digest, expected_digest);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -66,7 +66,7 @@ TEST(InitKuznechikCTXTest, FileReadSuccess) {
         { 0xbb, 0x44, 0xe2, 0x53, 0x78, 0xc7, 0x31, 0x23, 0xa5, 0xf3, 0x2f, 0x73, 0xcd, 0xb6, 0xe5, 0x17 },
         { 0x72, 0xe9, 0xdd, 0x74, 0x16, 0xbc, 0xf4, 0x5b, 0x75, 0x5d, 0xba, 0xa8, 0x8e, 0x4a, 0x40, 0x43 }
     };
-    const SecureBuffer<16> *result_round_keys = ctx.getCipherCTX().getKeySchedule();
+    const std::array<SecureBuffer<16>, 10> result_round_keys = ctx.getCipherCTX().getKeySchedule();
     for (uint8_t i = 0; i < 10; ++i)
         EXPECT_EQ(round_keys[i], result_round_keys[i]) << "Не совпал ключ " << i;
     remove("test_key.bin");